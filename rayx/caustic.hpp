@@ -0,0 +1,140 @@
+#pragma once
+
+#include <Tracer/Tracer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace caustic {
+
+struct Vec3 {
+    double x, y, z;
+};
+
+inline double dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline Vec3 cross(const Vec3& a, const Vec3& b) { return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x}; }
+inline Vec3 normalize(const Vec3& a) {
+    const double n = std::sqrt(dot(a, a));
+    return {a.x / n, a.y / n, a.z / n};
+}
+
+// Beam size and centroid on a family of parallel planes behind an element.
+struct Result {
+    std::vector<double> centroid_u, centroid_v, rms_width, rms_height;
+    double best_focus = std::numeric_limits<double>::quiet_NaN();
+    double waist = std::numeric_limits<double>::quiet_NaN();
+    uint64_t rays = 0;
+};
+
+// Propagates the rays that hit `object` along their directions to planes at `distances` and returns the beam size
+// and centroid on each plane.
+//
+// The planes are perpendicular to `axis`: "beam" (the mean ray direction) or one of "x", "y", "z". Distances are
+// measured along that axis from the beam centroid at the element. Width and height are measured along two orthonormal
+// in-plane axes u and v; for "beam" u is horizontal (perpendicular to y), for a coordinate axis they are the two other
+// coordinate axes in cyclic order.
+//
+// A ray's in-plane coordinate is linear in the plane distance d: q(d) = A + B d. The first and second moments of A and B
+// are gathered in two passes over the rays, after which every plane costs O(1), so no per-plane arrays are allocated
+// and the cost is independent of the number of rays per plane. The best focus is the sampled distance with the
+// smallest rms_width^2 + rms_height^2; the waist is the unconstrained minimum of the same quadratic.
+inline Result compute(const rayx::Rays& rays, int64_t object, const std::vector<double>& distances, const std::string& axis) {
+    std::vector<size_t> hits;
+    for (size_t i = 0; i < rays.object_id.size(); ++i)
+        if (rays.event_type[i] == rayx::EventType::HitElement && static_cast<int64_t>(rays.object_id[i]) == object) hits.push_back(i);
+    if (hits.empty()) throw std::invalid_argument("No rays hit object " + std::to_string(object) + ".");
+
+    auto position = [&](size_t i) { return Vec3{rays.position_x[i], rays.position_y[i], rays.position_z[i]}; };
+    auto direction = [&](size_t i) { return Vec3{rays.direction_x[i], rays.direction_y[i], rays.direction_z[i]}; };
+
+    Vec3 c{0, 0, 0}, meanDir{0, 0, 0};
+    for (size_t i : hits) {
+        const Vec3 p = position(i), d = direction(i);
+        c = {c.x + p.x, c.y + p.y, c.z + p.z};
+        meanDir = {meanDir.x + d.x, meanDir.y + d.y, meanDir.z + d.z};
+    }
+    const double inv = 1.0 / static_cast<double>(hits.size());
+    c = {c.x * inv, c.y * inv, c.z * inv};
+
+    Vec3 n, u, v;
+    if (axis == "beam") {
+        n = normalize(meanDir);
+        u = std::abs(n.y) < 0.9 ? normalize(cross({0, 1, 0}, n)) : normalize(cross({1, 0, 0}, n));
+        v = cross(n, u);
+    } else if (axis == "x") {
+        n = {1, 0, 0}, u = {0, 1, 0}, v = {0, 0, 1};
+    } else if (axis == "y") {
+        n = {0, 1, 0}, u = {0, 0, 1}, v = {1, 0, 0};
+    } else if (axis == "z") {
+        n = {0, 0, 1}, u = {1, 0, 0}, v = {0, 1, 0};
+    } else {
+        throw std::invalid_argument("axis must be 'beam', 'x', 'y' or 'z', got '" + axis + "'.");
+    }
+
+    // Per-ray linear model of the in-plane coordinates, first pass: means.
+    struct Moments {
+        double mA = 0, mB = 0, vA = 0, vB = 0, cAB = 0;
+    } mu, mv;
+    auto coefficients = [&](size_t i, double& au, double& bu, double& av, double& bv) {
+        const Vec3 p = position(i), d = direction(i);
+        const Vec3 r{p.x - c.x, p.y - c.y, p.z - c.z};
+        const double k = dot(d, n);
+        if (std::abs(k) < 1e-12) return false;  // parallel to the planes: never reaches them
+        const double s = dot(r, n);
+        bu = dot(d, u) / k, bv = dot(d, v) / k;
+        au = dot(r, u) - s * bu, av = dot(r, v) - s * bv;
+        return true;
+    };
+
+    uint64_t count = 0;
+    for (size_t i : hits) {
+        double au, bu, av, bv;
+        if (!coefficients(i, au, bu, av, bv)) continue;
+        ++count;
+        mu.mA += au, mu.mB += bu, mv.mA += av, mv.mB += bv;
+    }
+    if (count == 0) throw std::invalid_argument("All rays at object " + std::to_string(object) + " are parallel to the planes.");
+    const double invCount = 1.0 / static_cast<double>(count);
+    mu.mA *= invCount, mu.mB *= invCount, mv.mA *= invCount, mv.mB *= invCount;
+
+    // Second pass: centred second moments, which stay accurate far from the element.
+    for (size_t i : hits) {
+        double au, bu, av, bv;
+        if (!coefficients(i, au, bu, av, bv)) continue;
+        const double du = au - mu.mA, eu = bu - mu.mB, dv = av - mv.mA, ev = bv - mv.mB;
+        mu.vA += du * du, mu.vB += eu * eu, mu.cAB += du * eu;
+        mv.vA += dv * dv, mv.vB += ev * ev, mv.cAB += dv * ev;
+    }
+    for (Moments* m : {&mu, &mv}) m->vA *= invCount, m->vB *= invCount, m->cAB *= invCount;
+
+    Result result;
+    result.rays = count;
+    const size_t numPlanes = distances.size();
+    result.centroid_u.resize(numPlanes), result.centroid_v.resize(numPlanes);
+    result.rms_width.resize(numPlanes), result.rms_height.resize(numPlanes);
+    double best = std::numeric_limits<double>::infinity();
+    for (size_t k = 0; k < numPlanes; ++k) {
+        const double d = distances[k];
+        const double varU = std::max(0.0, mu.vA + 2.0 * mu.cAB * d + mu.vB * d * d);
+        const double varV = std::max(0.0, mv.vA + 2.0 * mv.cAB * d + mv.vB * d * d);
+        result.centroid_u[k] = mu.mA + mu.mB * d;
+        result.centroid_v[k] = mv.mA + mv.mB * d;
+        result.rms_width[k] = std::sqrt(varU);
+        result.rms_height[k] = std::sqrt(varV);
+        if (varU + varV < best) {
+            best = varU + varV;
+            result.best_focus = d;
+        }
+    }
+    const double curvature = mu.vB + mv.vB;
+    if (curvature > 0.0) result.waist = -(mu.cAB + mv.cAB) / curvature;
+    return result;
+}
+
+}  // namespace caustic
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <Beamline/Beamline.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace components {
+
+// A beamline component: an optical element or a source.
+using Component = std::variant<rayx::DesignElement*, rayx::DesignSource*>;
+
+// All components in the order of Beamline.elements followed by Beamline.sources.
+inline std::vector<Component> all(rayx::Beamline& bl) {
+    std::vector<Component> out;
+    for (auto element : bl.getElements()) out.emplace_back(element);
+    for (auto source : bl.getSources()) out.emplace_back(source);
+    return out;
+}
+
+inline std::string name(const Component& c) {
+    return std::visit([](auto* p) { return p->getName(); }, c);
+}
+
+// Incremented whenever a component is renamed through its `name` property. Indices built before a rename are stale.
+inline std::atomic<uint64_t>& renameGeneration() {
+    static std::atomic<uint64_t> generation{0};
+    return generation;
+}
+
+// Name -> component index of one beamline. It is rebuilt on the next lookup after any rename, since a rename may also
+// give a component the name of a later one, which then no longer wins. Lookups additionally verify the name of the
+// component they find.
+class Index {
+  public:
+    explicit Index(rayx::Beamline& bl) { rebuild(bl); }
+
+    const std::vector<Component>& all() const { return m_all; }
+
+    std::optional<Component> find(rayx::Beamline& bl, const std::string& name) {
+        if (m_generation != renameGeneration().load()) rebuild(bl);
+        if (auto c = lookup(name)) return c;
+        rebuild(bl);
+        return lookup(name);
+    }
+
+    // Component names in order; rebuilt first so that renames are reflected.
+    std::vector<std::string> names(rayx::Beamline& bl) {
+        rebuild(bl);
+        std::vector<std::string> out;
+        out.reserve(m_all.size());
+        for (const auto& c : m_all) out.push_back(name(c));
+        return out;
+    }
+
+  private:
+    std::optional<Component> lookup(const std::string& name) const {
+        auto it = m_byName.find(name);
+        if (it == m_byName.end() || components::name(m_all[it->second]) != name) return std::nullopt;
+        return m_all[it->second];
+    }
+
+    void rebuild(rayx::Beamline& bl) {
+        // Read first, so that a rename racing with the rebuild leaves the index stale rather than wrong.
+        m_generation = renameGeneration().load();
+        m_all = components::all(bl);
+        m_byName.clear();
+        // Like a linear scan, the first component with a given name wins.
+        for (size_t i = 0; i < m_all.size(); ++i) m_byName.try_emplace(name(m_all[i]), i);
+    }
+
+    std::vector<Component> m_all;
+    std::unordered_map<std::string, size_t> m_byName;
+    uint64_t m_generation = 0;
+};
+
+inline glm::dvec4 position(const Component& c) {
+    return std::visit([](auto* p) { return p->getPosition(); }, c);
+}
+
+inline glm::dmat4x4 orientation(const Component& c) {
+    return std::visit([](auto* p) { return p->getOrientation(); }, c);
+}
+
+inline void setPosition(const Component& c, const glm::dvec4& position) {
+    std::visit([&](auto* p) { p->setPosition(position); }, c);
+}
+
+inline void setOrientation(const Component& c, const glm::dmat4x4& orientation) {
+    std::visit([&](auto* p) { p->setOrientation(orientation); }, c);
+}
+
+// Nominal pose of a component, saved so that a perturbation can be undone.
+struct Pose {
+    glm::dvec4 position;
+    glm::dmat4x4 orientation;
+};
+
+inline Pose pose(const Component& c) { return {position(c), orientation(c)}; }
+
+inline void setPose(const Component& c, const Pose& p) {
+    setPosition(c, p.position);
+    setOrientation(c, p.orientation);
+}
+
+// Applies a rigid misalignment given in the component's own frame: a translation (dx, dy, dz) along its local axes and
+// rotations (rx, ry, rz) in radians about its local x, y and z axes, in that order.
+inline Pose misalign(const Pose& nominal, const std::array<double, 6>& d) {
+    const double cx = std::cos(d[3]), sx = std::sin(d[3]);
+    const double cy = std::cos(d[4]), sy = std::sin(d[4]);
+    const double cz = std::cos(d[5]), sz = std::sin(d[5]);
+
+    // glm matrices are column-major: m[col][row].
+    glm::dmat4x4 rx(1.0), ry(1.0), rz(1.0);
+    rx[1][1] = cx, rx[2][1] = -sx, rx[1][2] = sx, rx[2][2] = cx;
+    ry[0][0] = cy, ry[2][0] = sy, ry[0][2] = -sy, ry[2][2] = cy;
+    rz[0][0] = cz, rz[1][0] = -sz, rz[0][1] = sz, rz[1][1] = cz;
+
+    Pose out;
+    out.position = nominal.position + nominal.orientation * glm::dvec4(d[0], d[1], d[2], 0.0);
+    out.orientation = nominal.orientation * (rz * ry * rx);
+    return out;
+}
+
+// Saves design state that a study perturbs and restores it on destruction, like RayCountOverride does for ray counts, so
+// the beamline is left as it was found even if a trace throws.
+class DesignRestore {
+  public:
+    DesignRestore() = default;
+    ~DesignRestore() {
+        for (const auto& [c, p] : m_poses) setPose(c, p);
+        for (const auto& [source, energy] : m_sourceEnergies) source->setEnergy(energy);
+        for (const auto& [element, energy] : m_designEnergies) element->setDesignEnergy(energy);
+    }
+    DesignRestore(const DesignRestore&) = delete;
+    DesignRestore& operator=(const DesignRestore&) = delete;
+
+    // Saves the pose of `c` and returns it.
+    Pose savePose(const Component& c) { return m_poses.emplace_back(c, pose(c)).second; }
+
+    void saveEnergy(rayx::DesignSource* source) { m_sourceEnergies.emplace_back(source, source->getEnergy()); }
+
+    void saveDesignEnergy(rayx::DesignElement* element) { m_designEnergies.emplace_back(element, element->getDesignEnergy()); }
+
+  private:
+    std::vector<std::pair<Component, Pose>> m_poses;
+    std::vector<std::pair<rayx::DesignSource*, double>> m_sourceEnergies;
+    std::vector<std::pair<rayx::DesignElement*, double>> m_designEnergies;
+};
+
+// Splits n in proportion to `weights` so that the parts sum to exactly n (largest remainder method). Every part is its
+// proportional share rounded down or up, so as long as n <= sum(weights) no part exceeds its weight. All parts are zero
+// if all weights are.
+inline std::vector<uint64_t> apportion(uint64_t n, const std::vector<uint64_t>& weights) {
+    std::vector<uint64_t> parts(weights.size(), 0);
+    unsigned __int128 total = 0;
+    for (uint64_t w : weights) total += w;
+    if (total == 0) return parts;
+
+    std::vector<unsigned __int128> remainders(weights.size());
+    uint64_t assigned = 0;
+    for (size_t k = 0; k < weights.size(); ++k) {
+        const unsigned __int128 share = static_cast<unsigned __int128>(n) * weights[k];
+        parts[k] = static_cast<uint64_t>(share / total);
+        remainders[k] = share % total;
+        assigned += parts[k];
+    }
+    // The shortfall is less than the number of parts; it goes to the largest remainders, earlier parts first on ties.
+    std::vector<size_t> order(weights.size());
+    for (size_t k = 0; k < order.size(); ++k) order[k] = k;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return remainders[a] > remainders[b]; });
+    for (size_t i = 0; assigned < n; ++i, ++assigned) ++parts[order[i]];
+    return parts;
+}
+
+// Temporarily overrides the number of rays emitted by every source, e.g. to trace a beamline in batches. The original
+// counts are restored on destruction.
+class RayCountOverride {
+  public:
+    explicit RayCountOverride(rayx::Beamline& bl) : m_sources(bl.getSources()) {
+        for (auto* source : m_sources) {
+            m_nominal.push_back(static_cast<uint64_t>(source->getNumberOfRays()));
+            m_nominalTotal += m_nominal.back();
+        }
+        m_taken.assign(m_sources.size(), 0);
+    }
+    ~RayCountOverride() {
+        for (size_t k = 0; k < m_sources.size(); ++k) setCount(k, m_nominal[k]);
+    }
+    RayCountOverride(const RayCountOverride&) = delete;
+    RayCountOverride& operator=(const RayCountOverride&) = delete;
+
+    // Total number of rays the sources emit without the override.
+    uint64_t nominalTotal() const { return m_nominalTotal; }
+
+    // Lets the sources together emit exactly `total` rays (any number, also beyond their nominal counts), split in
+    // proportion to their nominal counts. Returns `total`, or 0 if no source emits rays.
+    uint64_t set(uint64_t total) { return apply(apportion(total, m_nominal)); }
+
+    // Lets the sources together emit the next `n` of their nominal rays, or all that remain if fewer. The batch is split in
+    // proportion to the rays each source has left, so successive calls emit exactly the nominal count of every source in
+    // total. Returns the number of rays emitted.
+    uint64_t take(uint64_t n) {
+        std::vector<uint64_t> remaining(m_sources.size());
+        uint64_t left = 0;
+        for (size_t k = 0; k < m_sources.size(); ++k) {
+            remaining[k] = m_nominal[k] - m_taken[k];
+            left += remaining[k];
+        }
+        const auto parts = apportion(std::min(n, left), remaining);
+        for (size_t k = 0; k < parts.size(); ++k) m_taken[k] += parts[k];
+        return apply(parts);
+    }
+
+  private:
+    uint64_t apply(const std::vector<uint64_t>& parts) {
+        uint64_t emitted = 0;
+        for (size_t k = 0; k < parts.size(); ++k) {
+            setCount(k, parts[k]);
+            emitted += parts[k];
+        }
+        return emitted;
+    }
+
+    void setCount(size_t k, uint64_t n) {
+        using Count = decltype(m_sources[k]->getNumberOfRays());
+        m_sources[k]->setNumberOfRays(static_cast<std::remove_cvref_t<Count>>(n));
+    }
+
+    std::vector<rayx::DesignSource*> m_sources;
+    std::vector<uint64_t> m_nominal;
+    std::vector<uint64_t> m_taken;
+    uint64_t m_nominalTotal = 0;
+};
+
+}  // namespace components
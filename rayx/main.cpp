@@ -8,14 +8,33 @@
 #include <nanobind/nanobind.h>
 #include <nanobind/ndarray.h>
 #include <nanobind/stl/array.h>
+#include <nanobind/stl/filesystem.h>
 #include <nanobind/stl/optional.h>
+#include <nanobind/stl/pair.h>
 #include <nanobind/stl/string.h>
 #include <nanobind/stl/vector.h>
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
 #include <concepts>
+#include <cstring>
 #include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string_view>
+#include <type_traits>
 
+#include "caustic.hpp"
+#include "components.hpp"
+#include "rays.hpp"
 #include "reflection.hpp"
+#include "stats.hpp"
+#include "trace_cache.hpp"
 
 std::complex<double> toStdComplex(const rayx::complex::Complex& c) { return std::complex<double>(c.real(), c.imag()); }
 
@@ -24,6 +43,308 @@ std::filesystem::path getModulePath(py::module_ m) {
     return std::filesystem::path(py::cast<std::string>(m.attr("__file__"))).parent_path();
 }
 
+// Serialises access to the process-global state of rayx-core: the RNG seeded by fixSeed/randomSeed and read while
+// tracing, and the cached Tracers, which are not reentrant. Held for the duration of every seed-and-trace sequence, so
+// concurrent traces from several threads stay deterministic for a given seed.
+std::mutex& engineMutex() {
+    static std::mutex m;
+    return m;
+}
+
+// Seed the RNG: a given seed yields deterministic results, otherwise the seed is derived from system time.
+void seedRng(std::optional<uint32_t> seed) {
+    if (seed)
+        rayx::fixSeed(*seed);
+    else
+        rayx::randomSeed();
+}
+
+rayx::DeviceConfig makeDeviceConfig(rayx::DeviceConfig::DeviceType device_type, std::optional<int> device_index) {
+    // We validate device_index here rather than let enableDeviceByIndex() call RAYX_EXIT,
+    // which would terminate the Python interpreter.
+    rayx::DeviceConfig deviceConfig(device_type);
+    if (deviceConfig.devices.empty())
+        throw std::runtime_error(
+            "No compute device available for the requested device_type. Use list_devices() to see the available devices "
+            "(note: GPU tracing requires a CUDA-enabled build and an NVIDIA GPU).");
+    if (device_index) {
+        if (*device_index < 0 || static_cast<size_t>(*device_index) >= deviceConfig.devices.size())
+            throw std::out_of_range("device_index " + std::to_string(*device_index) + " is out of range; use list_devices() to see the available devices");
+        deviceConfig.enableDeviceByIndex(static_cast<size_t>(*device_index));
+    } else {
+        deviceConfig.enableBestDevice();
+    }
+    return deviceConfig;
+}
+
+// A Tracer holds device memory sized by the largest trace it ran. By default every call therefore builds its own Tracer
+// and releases it when done; calls that trace several times (batches, sweeps) reuse theirs across those traces. With
+// set_tracer_cache(True), Tracers are instead kept per device selection, so that repeated traces, and short-lived workers
+// issuing several, skip the device setup. The cache is deliberately leaked so that device resources are not torn down
+// during interpreter shutdown; clear_tracer_cache() releases them explicitly. Callers hold a shared_ptr, so a Tracer stays
+// valid for a running computation even if the cache is cleared meanwhile.
+std::atomic<bool>& keepTracers() {
+    static std::atomic<bool> keep{false};
+    return keep;
+}
+
+std::mutex& tracerCacheMutex() {
+    static std::mutex m;
+    return m;
+}
+
+std::map<std::pair<int, int>, std::shared_ptr<rayx::Tracer>>& tracerCache() {
+    static auto* cache = new std::map<std::pair<int, int>, std::shared_ptr<rayx::Tracer>>();
+    return *cache;
+}
+
+std::shared_ptr<rayx::Tracer> acquireTracer(rayx::DeviceConfig::DeviceType device_type, std::optional<int> device_index) {
+    if (!keepTracers().load()) return std::make_shared<rayx::Tracer>(makeDeviceConfig(device_type, device_index));
+    const std::pair<int, int> key{static_cast<int>(device_type), device_index.value_or(-1)};
+
+    std::lock_guard lock(tracerCacheMutex());
+    auto& cache = tracerCache();
+    auto it = cache.find(key);
+    if (it == cache.end()) it = cache.emplace(key, std::make_shared<rayx::Tracer>(makeDeviceConfig(device_type, device_index))).first;
+    return it->second;
+}
+
+void releaseTracers() {
+    std::map<std::pair<int, int>, std::shared_ptr<rayx::Tracer>> released;
+    {
+        std::lock_guard lock(tracerCacheMutex());
+        released.swap(tracerCache());
+    }
+    // Tracers still in use by a running trace are destroyed when it finishes.
+    py::gil_scoped_release release;
+    released.clear();
+}
+
+// Seeds the RNG and traces `bl`. The GIL is released while tracing so that other Python threads keep running; the caller
+// must not let another thread mutate `bl` in the meantime (see "Thread safety" in the README).
+rayx::Rays traceBeamline(rayx::Tracer& tracer, rayx::Beamline& bl, std::optional<uint32_t> seed, bool sequential, std::optional<int> max_events) {
+    rayx::ObjectMask obj_mask = rayx::ObjectMask::all();
+    rayx::RayAttrMask attr_mask = rayx::RayAttrMask::All;
+    rayx::Sequential seq = sequential ? rayx::Sequential::Yes : rayx::Sequential::No;
+
+    py::gil_scoped_release release;
+    std::lock_guard lock(engineMutex());
+    seedRng(seed);
+    return tracer.trace(bl, seq, obj_mask, attr_mask, max_events, std::nullopt);
+}
+
+// Number of live exports (numpy views, pickle buffers) of the column storage of a Rays object. Copies start at zero:
+// the exports belong to the storage of the object they were taken from.
+struct ExportCount {
+    std::atomic<size_t> n{0};
+
+    ExportCount() = default;
+    ExportCount(const ExportCount&) {}
+    ExportCount& operator=(const ExportCount&) { return *this; }
+};
+
+// The given seed, or one drawn from std::random_device. Calls that trace several times draw it once and derive every
+// trace's seed from it.
+uint32_t drawSeed(std::optional<uint32_t> seed) { return seed ? *seed : std::random_device{}(); }
+
+// Traces one beamline repeatedly and reduces every trace to per-object beam statistics, for studies that compare traces
+// of a perturbed beamline (sensitivity, misalignment_study, energy_scan). All traces share one Tracer and one seed:
+// with common random numbers they emit identical source rays and draw identical random streams, so differences between
+// them come from the perturbation rather than from Monte Carlo noise.
+class StudyTracer {
+  public:
+    StudyTracer(std::optional<uint32_t> seed, bool sequential, std::optional<int> max_events, rayx::DeviceConfig::DeviceType device_type,
+                std::optional<int> device_index)
+        : m_tracer(acquireTracer(device_type, device_index)), m_seed(drawSeed(seed)), m_sequential(sequential), m_maxEvents(max_events) {}
+
+    std::vector<stats::BeamStats> beamStats(rayx::Beamline& bl) const {
+        return stats::collect(traceBeamline(*m_tracer, bl, m_seed, m_sequential, m_maxEvents), bl.getElements().size());
+    }
+
+  private:
+    std::shared_ptr<rayx::Tracer> m_tracer;
+    uint32_t m_seed;
+    bool m_sequential;
+    std::optional<int> m_maxEvents;
+};
+
+// Rays as exposed to Python: the recorded events plus the number of source rays they were traced from, so that the
+// result of a trace that stopped early can be re-weighted. Rays not produced by a trace report 0 source rays.
+struct TracedRays : rayx::Rays {
+    uint64_t sourceRays = 0;
+    bool complete = true;
+    // Column storage must not be reallocated while this is non-zero (see storeInto).
+    ExportCount exports;
+};
+
+// Traces `bl` in batches of `batchSize` source rays (the last one smaller), batch k seeded with seed + k. Without a
+// seed, the base seed is drawn once, since reseeding from the clock per batch can repeat a stream. Stops before a batch
+// that is predicted (from the duration of the previous one) to end after `end`, and before a batch if Python received
+// a KeyboardInterrupt meanwhile, which is then cleared since the partial result reports it (complete is false). Signals
+// are only handled while batches remain, so an interrupt during the last batch stays pending and is raised as usual;
+// exceptions raised by other signal handlers propagate. The sources' ray counts are restored afterwards.
+TracedRays traceInBatches(rayx::Tracer& tracer, rayx::Beamline& bl, std::optional<uint32_t> seed, bool sequential, std::optional<int> max_events,
+                            uint64_t batchSize, std::chrono::steady_clock::time_point end) {
+    using Clock = std::chrono::steady_clock;
+    components::RayCountOverride rayCount(bl);
+    const uint64_t total = rayCount.nominalTotal();
+
+    const uint32_t baseSeed = drawSeed(seed);
+    TracedRays result;
+    Clock::duration lastDuration{};
+    uint64_t lastRays = 0;
+    for (uint32_t k = 0; result.sourceRays < total; ++k) {
+        if (k > 0 && PyErr_CheckSignals() != 0) {
+            if (!PyErr_ExceptionMatches(PyExc_KeyboardInterrupt)) throw py::python_error();
+            PyErr_Clear();
+            break;
+        }
+        const uint64_t n = std::min(batchSize, total - result.sourceRays);
+        const auto predicted = lastRays > 0 ? std::chrono::duration_cast<Clock::duration>(lastDuration * (static_cast<double>(n) / static_cast<double>(lastRays)))
+                                            : Clock::duration::zero();
+        if (Clock::now() + predicted > end) break;
+
+        const uint64_t emitted = rayCount.take(n);
+        if (emitted == 0) break;
+        const auto start = Clock::now();
+        const rayx::Rays batch = traceBeamline(tracer, bl, baseSeed + k, sequential, max_events);
+        lastDuration = Clock::now() - start;
+        lastRays = emitted;
+        ray_columns::append(result, batch, result.sourceRays);
+        result.sourceRays += emitted;
+    }
+    result.complete = result.sourceRays >= total;
+    return result;
+}
+
+// The earlier of `time_budget` seconds from now and the Unix time `deadline`.
+std::chrono::steady_clock::time_point traceEnd(std::optional<double> time_budget, std::optional<double> deadline) {
+    using Clock = std::chrono::steady_clock;
+    const auto now = Clock::now();
+    // Clamped so that absurdly large budgets cannot overflow the clock.
+    auto after = [&](double seconds) {
+        return now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(std::clamp(seconds, -1e9, 1e9)));
+    };
+    auto end = Clock::time_point::max();
+    if (time_budget) {
+        if (!(*time_budget >= 0.0)) throw std::invalid_argument("time_budget must be non-negative.");
+        end = std::min(end, after(*time_budget));
+    }
+    if (deadline) {
+        if (std::isnan(*deadline)) throw std::invalid_argument("deadline must not be NaN.");
+        const double unixNow = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+        end = std::min(end, after(*deadline - unixNow));
+    }
+    return end;
+}
+
+// A scalar design parameter addressed from Python as "<component name>.<attribute>[.<sub attribute>...]",
+// e.g. "M1.grazingIncAngle.rad" or "M1.position.x". It is read and written through the bound Python properties,
+// so every numeric field reachable via attribute access can be perturbed.
+struct ParamRef {
+    py::object owner;
+    std::string attr;
+
+    double get() const { return py::cast<double>(py::getattr(owner, attr.c_str())); }
+    void set(double value) const { py::setattr(owner, attr.c_str(), py::float_(value)); }
+};
+
+// Component indices of the Beamlines alive in Python, keyed by Beamline. An entry is dropped by a weakref callback when
+// its Beamline's Python object dies, before the Beamline itself is destroyed. Deliberately leaked, like the Tracer
+// cache, so that no Python object is released during interpreter shutdown.
+struct IndexEntry {
+    components::Index index;
+    py::object weakref;
+};
+
+std::mutex& indexMutex() {
+    static std::mutex m;
+    return m;
+}
+
+std::map<const rayx::Beamline*, IndexEntry>& indices() {
+    static auto* m = new std::map<const rayx::Beamline*, IndexEntry>();
+    return *m;
+}
+
+// Calls f with the component index of `bl`, building it on first use. f runs with the index locked and must not call
+// into Python; the weakref is created outside the lock because doing so may run arbitrary Python code (e.g. the GC).
+template <typename F>
+auto withIndex(rayx::Beamline& bl, F&& f) {
+    {
+        std::lock_guard lock(indexMutex());
+        auto it = indices().find(&bl);
+        if (it != indices().end()) return f(it->second.index);
+    }
+
+    py::object self = py::find(bl);
+    if (!self.is_valid()) {
+        components::Index index(bl);
+        return f(index);
+    }
+    const rayx::Beamline* key = &bl;
+    py::object ref = py::weakref(self, py::cpp_function([key](py::handle) {
+                                     py::object dropped;
+                                     std::lock_guard lock(indexMutex());
+                                     auto it = indices().find(key);
+                                     if (it == indices().end()) return;
+                                     dropped = std::move(it->second.weakref);
+                                     indices().erase(it);
+                                 }));
+
+    std::lock_guard lock(indexMutex());
+    // If another thread registered the index meanwhile, `ref` is released (and its callback unregistered) unused.
+    auto it = indices().try_emplace(key, components::Index(bl), std::move(ref)).first;
+    return f(it->second.index);
+}
+
+std::optional<components::Component> lookupComponent(rayx::Beamline& bl, const std::string& name) {
+    return withIndex(bl, [&](components::Index& index) { return index.find(bl, name); });
+}
+
+// Raised for a component name that is not in the beamline. Exposed as rayx.ComponentNotFoundError, which derives from
+// KeyError (so `beamline[name]` behaves like a mapping lookup) and from RuntimeError (the type raised before).
+struct ComponentNotFound : std::runtime_error {
+    explicit ComponentNotFound(const std::string& name)
+        : std::runtime_error("No element or source with name '" + name + "' found in beamline.") {}
+};
+
+components::Component getComponent(rayx::Beamline& bl, const std::string& name) {
+    if (auto c = lookupComponent(bl, name)) return *c;
+    throw ComponentNotFound(name);
+}
+
+py::object findComponent(rayx::Beamline& bl, const std::string& name) {
+    return std::visit([](auto* p) { return py::cast(p); }, getComponent(bl, name));
+}
+
+ParamRef resolveParam(rayx::Beamline& bl, const std::string& path) {
+    // Component names may themselves contain dots, so try every split point from the left.
+    for (auto dot = path.find('.'); dot != std::string::npos; dot = path.find('.', dot + 1)) {
+        py::object owner;
+        try {
+            owner = findComponent(bl, path.substr(0, dot));
+        } catch (const ComponentNotFound&) {
+            continue;
+        }
+        std::string rest = path.substr(dot + 1);
+        for (auto next = rest.find('.'); next != std::string::npos; next = rest.find('.')) {
+            owner = py::getattr(owner, rest.substr(0, next).c_str());
+            rest = rest.substr(next + 1);
+        }
+        return ParamRef{owner, rest};
+    }
+    throw std::invalid_argument("Parameter '" + path + "' must have the form '<component name>.<attribute>' with an existing component.");
+}
+
+// Takes ownership of `data` and exposes it as a C-contiguous float64 numpy array of the given shape.
+template <size_t N>
+py::ndarray<py::numpy, double, py::ndim<N>> to_numpy_owned(std::vector<double>&& data, const std::array<size_t, N>& shape) {
+    auto* owned = new std::vector<double>(std::move(data));
+    py::capsule owner(owned, [](void* p) noexcept { delete static_cast<std::vector<double>*>(p); });
+    return py::ndarray<py::numpy, double, py::ndim<N>>(owned->data(), N, shape.data(), owner);
+}
+
 namespace nanobind::detail {
 
 // nanobind caster for glm::dmat4x4, used for the `orientation` property of DesignElement / DesignSource.
@@ -43,6 +364,26 @@ struct type_caster<glm::dmat4x4> {
     // Accepts a (4, 4) numpy array or a nested 4x4 sequence; rejects anything not exactly 4x4.
     bool from_python(handle src, uint8_t /*flags*/, cleanup_list* /*cleanup*/) noexcept {
         PyObject* obj = src.ptr();
+
+        // Fast path: a C-contiguous float64 buffer is read directly instead of element by element.
+        if (PyObject_CheckBuffer(obj)) {
+            Py_buffer view;
+            if (PyObject_GetBuffer(obj, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) == 0) {
+                const bool ok = view.ndim == 2 && view.shape[0] == 4 && view.shape[1] == 4 && view.itemsize == sizeof(double) &&
+                                view.format && (std::string_view(view.format) == "d" || std::string_view(view.format) == "<d" ||
+                                                std::string_view(view.format) == "=d");
+                if (ok) {
+                    const double* data = static_cast<const double*>(view.buf);
+                    for (int row = 0; row < 4; ++row)
+                        for (int col = 0; col < 4; ++col) value[col][row] = data[row * 4 + col];
+                }
+                PyBuffer_Release(&view);
+                if (ok) return true;
+            } else {
+                PyErr_Clear();
+            }
+        }
+
         if (PySequence_Length(obj) != 4) {
             PyErr_Clear();
             return false;
@@ -212,6 +553,10 @@ static_assert(Variant<rayx::Cutout>);
 template <>
 struct info<rayx::DesignElement> {
     static constexpr const char* type_name = "DesignElement";
+    // Renames make the component indices of all beamlines stale (see components::Index).
+    static void on_set(const rayx::DesignElement&, std::string_view field) {
+        if (field == "name") components::renameGeneration().fetch_add(1);
+    }
     static constexpr auto fields = std::make_tuple(
         prop_info{&rayx::DesignElement::getName, &rayx::DesignElement::setName, "name"},
         prop_info{&rayx::DesignElement::getType, &rayx::DesignElement::setType, "type"},
@@ -296,6 +641,9 @@ static_assert(Structure<rayx::DesignElement>);
 template <>
 struct info<rayx::DesignSource> {
     static constexpr const char* type_name = "Source";
+    static void on_set(const rayx::DesignSource&, std::string_view field) {
+        if (field == "name") components::renameGeneration().fetch_add(1);
+    }
 
     static constexpr auto fields = std::make_tuple(
         prop_info{&rayx::DesignSource::getName, &rayx::DesignSource::setName, "name"},
@@ -350,9 +698,190 @@ struct py::detail::dtype_traits<rayx::EventType> {
     static constexpr auto name = py::detail::dtype_traits<uint32_t>::name;
 };
 
+// Owner for an export of the column storage of the Rays object `self`: keeps `self` alive and counts as an export of it
+// until released.
+py::capsule exportOwner(py::handle self) {
+    py::capsule owner(self.ptr(), [](void* p) noexcept {
+        PyObject* rays = static_cast<PyObject*>(p);
+        py::inst_ptr<TracedRays>(rays)->exports.n.fetch_sub(1);
+        Py_DECREF(rays);
+    });
+    self.inc_ref();
+    py::inst_ptr<TracedRays>(self)->exports.n.fetch_add(1);
+    return owner;
+}
+
+// A numpy view of one column of the Rays object `self`.
+template <typename T>
+py::ndarray<py::numpy, T, py::ndim<1>> columnView(py::handle self, std::vector<T> rayx::Rays::*column) {
+    std::vector<T>& v = py::inst_ptr<TracedRays>(self)->*column;
+    return py::ndarray<py::numpy, T, py::ndim<1>>(v.data(), {v.size()}, exportOwner(self));
+}
+
+// Stores `src` in the existing column storage of `out`, so that numpy views of `out` keep pointing at its data; a view
+// keeps the length it was taken with. Like bytearray, refuses with BufferError to grow the storage while it is exported.
+void storeInto(TracedRays& out, const TracedRays& src) {
+    if (out.exports.n.load() > 0 && ray_columns::capacity(out) < ray_columns::size(src)) {
+        const std::string message = "Cannot grow Rays while numpy views of it exist: it holds " + std::to_string(ray_columns::capacity(out)) +
+                                    " events, the trace recorded " + std::to_string(ray_columns::size(src)) +
+                                    ". Release the views or reserve() more first.";
+        throw py::buffer_error(message.c_str());
+    }
+    ray_columns::copyInto(out, src);
+    out.sourceRays = src.sourceRays;
+    out.complete = src.complete;
+}
+
+// Identifies the devices a trace may run on: the requested selection and the devices available for it, so that results of
+// different devices (e.g. CPU and GPU, or GPUs on different machines sharing a cache) never share a key. Enumerating
+// devices can be slow, so this is cached per selection like the Tracers.
+const std::string& deviceKey(rayx::DeviceConfig::DeviceType device_type, std::optional<int> device_index) {
+    static auto* cache = new std::map<std::pair<int, int>, std::string>();
+    static std::mutex mutex;
+    const std::pair<int, int> key{static_cast<int>(device_type), device_index.value_or(-1)};
+
+    std::lock_guard lock(mutex);
+    auto it = cache->find(key);
+    if (it == cache->end()) {
+        trace_cache::Hasher h;
+        h.u64(static_cast<uint64_t>(key.first));
+        h.u64(static_cast<uint64_t>(static_cast<int64_t>(key.second)));
+        const rayx::DeviceConfig config(device_type);
+        h.u64(config.devices.size());
+        for (const auto& device : config.devices) {
+            h.string(device.name);
+            h.u64(static_cast<uint64_t>(device.type));
+        }
+        it = cache->emplace(key, h.hex()).first;
+    }
+    return it->second;
+}
+
+// Content hash identifying the result of a seeded trace, or nullopt if the beamline has inputs the key cannot cover.
+//
+// The key covers the design state of every element and source as listed in the reflection tables, the parameters left
+// out of them (VLS coefficients), the contents of referenced profile files, the trace arguments, the device selection
+// and the loaded binaries. Ray list sources and energy distributions read from a file are not cached: their data is not
+// reachable through the rayx-core API.
+std::optional<std::string> traceKey(rayx::Beamline& bl, uint32_t seed, bool sequential, std::optional<int> max_events,
+                                    rayx::DeviceConfig::DeviceType device_type, std::optional<int> device_index) {
+    trace_cache::Hasher h;
+    h.string(trace_cache::buildId({reinterpret_cast<const void*>(&deviceKey), reinterpret_cast<const void*>(&rayx::fixSeed)}));
+    h.string(deviceKey(device_type, device_index));
+
+    const auto elements = bl.getElements();
+    const auto sources = bl.getSources();
+    h.u64(elements.size());
+    for (auto* element : elements) {
+        trace_cache::hashValue(h, *element);
+        // getVLSParameters is commented out of the reflection table because it is not exposed to Python; reading it here
+        // in C++ is safe. It returns the coefficients by value and throws for elements without them, which is caught.
+        try {
+            trace_cache::hashValue(h, element->getVLSParameters());
+        } catch (const std::exception&) {
+            h.string("<unset>");
+        }
+        try {
+            const std::filesystem::path profile = element->getProfileFile();
+            if (!profile.empty()) trace_cache::hashFile(h, profile);
+        } catch (const std::exception&) {
+            h.string("<unset>");
+        }
+    }
+    h.u64(sources.size());
+    for (auto* source : sources) {
+        if (source->getType() == rayx::ElementType::RayListSource) return std::nullopt;
+        try {
+            if (source->getEnergyDistributionType() == rayx::EnergyDistributionType::File) return std::nullopt;
+        } catch (const std::exception&) {
+            // Sources without an energy distribution parameter.
+        }
+        trace_cache::hashValue(h, *source);
+    }
+    h.u64(seed);
+    h.u64(sequential);
+    h.u64(max_events ? static_cast<uint64_t>(*max_events) : ~uint64_t{0});
+    // Object and attribute masks are fixed to "all" by traceBeamline.
+    h.string("ObjectMask::all/RayAttrMask::All");
+    return h.hex();
+}
+
+// Pickle support for Rays. Each column is handed to the pickler as a flat byte buffer: with protocol 5 as a PickleBuffer
+// over the column storage itself, so out-of-band transports (multiprocessing, shared memory) move it without a copy;
+// with older protocols as a bytes copy.
+py::tuple reduceRays(py::handle self, int protocol) {
+    TracedRays& rays = py::cast<TracedRays&>(self);
+    py::object pickleBuffer = protocol >= 5 ? py::module_::import_("pickle").attr("PickleBuffer") : py::none();
+    py::dict columns;
+    ray_columns::forEach(rays, [&](const char* name, auto& column) {
+        using T = typename std::remove_cvref_t<decltype(column)>::value_type;
+        const size_t bytes = column.size() * sizeof(T);
+        if (protocol >= 5) {
+            // The byte view keeps `self` alive, and its storage in place, for as long as the pickler holds on to it.
+            py::ndarray<py::numpy, uint8_t, py::ndim<1>> view(reinterpret_cast<uint8_t*>(column.data()), {bytes}, exportOwner(self));
+            columns[name] = pickleBuffer(py::cast(view));
+        } else {
+            columns[name] = py::bytes(reinterpret_cast<const char*>(column.data()), bytes);
+        }
+    });
+    return py::make_tuple(py::type<TracedRays>().attr("from_buffers"), py::make_tuple(columns, rays.sourceRays, rays.complete));
+}
+
+// Whether a buffer with struct-module `format` and `itemsize` holds values of type T. Byte buffers ("B", "b", "c", or no
+// format, e.g. bytes or a PickleBuffer) are raw storage and accepted for any column.
 template <typename T>
-py::ndarray<py::numpy, T, py::ndim<1>> to_numpy(std::vector<T>& v) {
-    return py::ndarray<py::numpy, T, py::ndim<1>>(v.data(), {v.size()});
+bool bufferHolds(const char* format, Py_ssize_t itemsize) {
+    std::string_view f = format ? format : "B";
+    const char nativeOrder = std::endian::native == std::endian::little ? '<' : '>';
+    if (!f.empty() && (f[0] == '@' || f[0] == '=' || f[0] == nativeOrder)) f.remove_prefix(1);
+    if (f == "B" || f == "b" || f == "c") return true;
+    if (f.size() != 1 || static_cast<size_t>(itemsize) != sizeof(T)) return false;
+
+    using V = typename std::conditional_t<std::is_enum_v<T>, std::underlying_type<T>, std::type_identity<T>>::type;
+    std::string_view kinds;
+    if constexpr (std::is_same_v<V, bool>)
+        kinds = "?";
+    else if constexpr (std::is_floating_point_v<V>)
+        kinds = "efd";
+    else if constexpr (std::is_signed_v<V>)
+        kinds = "bhilqn";
+    else
+        kinds = "BHILQN";
+    return kinds.find(f[0]) != std::string_view::npos;
+}
+
+// Builds Rays from one C-contiguous buffer per column (bytes, memoryview, PickleBuffer, numpy array, shared memory, ...).
+// rayx::Rays stores its columns in std::vector, so every buffer is copied exactly once with a memcpy.
+TracedRays raysFromBuffers(py::dict columns, uint64_t source_rays, bool complete) {
+    TracedRays rays;
+    rays.sourceRays = source_rays;
+    rays.complete = complete;
+    std::optional<size_t> count;
+    ray_columns::forEach(rays, [&](const char* name, auto& column) {
+        using T = typename std::remove_cvref_t<decltype(column)>::value_type;
+        if (!columns.contains(name)) throw std::invalid_argument(std::string("from_buffers: missing column '") + name + "'.");
+        py::object obj = columns[name];
+        Py_buffer view;
+        if (PyObject_GetBuffer(obj.ptr(), &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0) throw py::python_error();
+        if (!bufferHolds<T>(view.format, view.itemsize)) {
+            const std::string format = view.format ? view.format : "B";
+            const auto itemsize = view.itemsize;
+            PyBuffer_Release(&view);
+            throw std::invalid_argument(std::string("from_buffers: column '") + name + "' has buffer format '" + format + "' (itemsize " +
+                                        std::to_string(itemsize) + "), which does not match its " + std::to_string(sizeof(T)) +
+                                        "-byte element type; pass an array of the column's dtype or raw bytes.");
+        }
+        const size_t bytes = static_cast<size_t>(view.len);
+        if (bytes % sizeof(T) != 0 || (count && *count != bytes / sizeof(T))) {
+            PyBuffer_Release(&view);
+            throw std::invalid_argument(std::string("from_buffers: column '") + name + "' has a size inconsistent with the other columns.");
+        }
+        count = bytes / sizeof(T);
+        column.resize(*count);
+        std::memcpy(column.data(), view.buf, bytes);
+        PyBuffer_Release(&view);
+    });
+    return rays;
 }
 
 NB_MODULE(core, m) {
@@ -363,6 +892,8 @@ NB_MODULE(core, m) {
 
     m.def("get_module_path", [=]() { return module_path.string(); }, "Get the path to the rayx module");
 
+    py::exception<ComponentNotFound>(m, "ComponentNotFoundError", py::make_tuple(py::handle(PyExc_KeyError), py::handle(PyExc_RuntimeError)));
+
     reflect::register_type<rayx::DesignElement>(m);
     reflect::register_type<rayx::DesignSource>(m);
 
@@ -493,76 +1024,117 @@ NB_MODULE(core, m) {
         .value("Gpu", rayx::DeviceConfig::DeviceType::Gpu)
         .value("All", rayx::DeviceConfig::DeviceType::All);
 
-    py::class_<rayx::Rays>(m, "Rays")
-        .def_prop_ro("path_id", [](rayx::Rays& rays) { return to_numpy(rays.path_id); })
-        .def_prop_ro("path_event_id", [](rayx::Rays& rays) { return to_numpy(rays.path_event_id); })
-        .def_prop_ro(
-            "position_x", [](rayx::Rays& rays) { return to_numpy(rays.position_x); }, py::rv_policy::reference_internal)
-        .def_prop_ro(
-            "position_y", [](rayx::Rays& rays) { return to_numpy(rays.position_y); }, py::rv_policy::reference_internal)
-        .def_prop_ro(
-            "position_z", [](rayx::Rays& rays) { return to_numpy(rays.position_z); }, py::rv_policy::reference_internal)
-        .def_prop_ro(
-            "direction_x", [](rayx::Rays& rays) { return to_numpy(rays.direction_x); }, py::rv_policy::reference_internal)
-        .def_prop_ro(
-            "direction_y", [](rayx::Rays& rays) { return to_numpy(rays.direction_y); }, py::rv_policy::reference_internal)
-        .def_prop_ro(
-            "direction_z", [](rayx::Rays& rays) { return to_numpy(rays.direction_z); }, py::rv_policy::reference_internal)
-        .def_prop_ro(
-            "electric_field_x", [](rayx::Rays& rays) { return to_numpy(rays.electric_field_x); }, py::rv_policy::reference_internal)
+    py::class_<TracedRays>(m, "Rays")
+        .def(py::init<>(), "Create an empty Rays object.")
+        .def("__len__", [](const TracedRays& rays) { return ray_columns::size(rays); })
         .def_prop_ro(
-            "electric_field_y", [](rayx::Rays& rays) { return to_numpy(rays.electric_field_y); }, py::rv_policy::reference_internal)
+            "capacity", [](const TracedRays& rays) { return ray_columns::capacity(rays); },
+            "Number of events this Rays holds without reallocating, e.g. when passed as Beamline.trace(out=...).")
+        .def(
+            "reserve",
+            [](TracedRays& rays, size_t n) {
+                if (n > ray_columns::capacity(rays) && rays.exports.n.load() > 0)
+                    throw py::buffer_error("Cannot grow Rays while numpy views of it exist.");
+                ray_columns::reserve(rays, n);
+            },
+            py::arg("n"),
+            "Pre-size every column to hold at least n events. Raises BufferError if that needs to reallocate while numpy views "
+            "exist.")
         .def_prop_ro(
-            "electric_field_z", [](rayx::Rays& rays) { return to_numpy(rays.electric_field_z); }, py::rv_policy::reference_internal)
+            "source_rays", [](const TracedRays& rays) { return rays.sourceRays; },
+            "Number of source rays these events were traced from; use it to re-weight a partial result. 0 for Rays not "
+            "produced by Beamline.trace().")
         .def_prop_ro(
-            "optical_path_length", [](rayx::Rays& rays) { return to_numpy(rays.optical_path_length); }, py::rv_policy::reference_internal)
-        .def_prop_ro(
-            "energy", [](rayx::Rays& rays) { return to_numpy(rays.energy); }, py::rv_policy::reference_internal)
-        .def_prop_ro(
-            "order", [](rayx::Rays& rays) { return to_numpy(rays.order); }, py::rv_policy::reference_internal)
-        .def_prop_ro(
-            "object_id", [](rayx::Rays& rays) { return to_numpy(rays.object_id); }, py::rv_policy::reference_internal)
-        .def_prop_ro(
-            "source_id", [](rayx::Rays& rays) { return to_numpy(rays.source_id); }, py::rv_policy::reference_internal)
-        .def_prop_ro("event_type", [](rayx::Rays& rays) { return to_numpy(rays.event_type); }, py::rv_policy::reference_internal);
+            "complete", [](const TracedRays& rays) { return rays.complete; },
+            "False if the trace was cut short by its time limit or an interrupt.")
+        .def("__reduce_ex__", &reduceRays, py::arg("protocol"))
+        .def(
+            "caustic",
+            [](const TracedRays& rays, int64_t object, const std::vector<double>& distances, const std::string& axis) {
+                caustic::Result c = caustic::compute(rays, object, distances, axis);
+                const size_t n = distances.size();
+                py::dict result;
+                result["distance"] = to_numpy_owned<1>(std::vector<double>(distances), {n});
+                result["centroid_u"] = to_numpy_owned<1>(std::move(c.centroid_u), {n});
+                result["centroid_v"] = to_numpy_owned<1>(std::move(c.centroid_v), {n});
+                result["rms_width"] = to_numpy_owned<1>(std::move(c.rms_width), {n});
+                result["rms_height"] = to_numpy_owned<1>(std::move(c.rms_height), {n});
+                result["best_focus"] = c.best_focus;
+                result["waist"] = c.waist;
+                result["rays"] = c.rays;
+                return result;
+            },
+            py::arg("object"), py::arg("distances"), py::arg("axis") = "beam",
+            "Beam caustic behind an element: propagate the rays that hit it to planes at the given distances.\n\n"
+            "object: object id of the element (its index in Beamline.elements).\n"
+            "distances: plane distances in mm, measured along the axis from the beam centroid at the element.\n"
+            "axis: 'beam' (planes perpendicular to the mean ray direction) or 'x', 'y', 'z' (perpendicular to that "
+            "coordinate axis, in the frame the rays were recorded in).\n"
+            "Returns a dict with float64 arrays 'distance', 'centroid_u', 'centroid_v', 'rms_width', 'rms_height', the sampled "
+            "distance with the smallest spot 'best_focus', the analytic minimum 'waist' (NaN if the beam does not converge) "
+            "and the number of 'rays' used. The cost is one pass over the rays plus O(1) per plane.")
+        .def_static("from_buffers", &raysFromBuffers, py::arg("columns"), py::arg("source_rays") = uint64_t{0}, py::arg("complete") = true,
+                    "Build Rays from a dict mapping every column name to a C-contiguous buffer of its raw values, e.g. the "
+                    "buffers produced by pickling with protocol 5 or blocks in multiprocessing.shared_memory. Typed buffers "
+                    "(e.g. numpy arrays) must match the column's dtype; byte buffers are taken as raw values. Each buffer is "
+                    "copied once into the Rays columns. source_rays and complete set the properties of the same name.")
+        .def_prop_ro("path_id", [](py::handle self) { return columnView(self, &rayx::Rays::path_id); })
+        .def_prop_ro("path_event_id", [](py::handle self) { return columnView(self, &rayx::Rays::path_event_id); })
+        .def_prop_ro("position_x", [](py::handle self) { return columnView(self, &rayx::Rays::position_x); })
+        .def_prop_ro("position_y", [](py::handle self) { return columnView(self, &rayx::Rays::position_y); })
+        .def_prop_ro("position_z", [](py::handle self) { return columnView(self, &rayx::Rays::position_z); })
+        .def_prop_ro("direction_x", [](py::handle self) { return columnView(self, &rayx::Rays::direction_x); })
+        .def_prop_ro("direction_y", [](py::handle self) { return columnView(self, &rayx::Rays::direction_y); })
+        .def_prop_ro("direction_z", [](py::handle self) { return columnView(self, &rayx::Rays::direction_z); })
+        .def_prop_ro("electric_field_x", [](py::handle self) { return columnView(self, &rayx::Rays::electric_field_x); })
+        .def_prop_ro("electric_field_y", [](py::handle self) { return columnView(self, &rayx::Rays::electric_field_y); })
+        .def_prop_ro("electric_field_z", [](py::handle self) { return columnView(self, &rayx::Rays::electric_field_z); })
+        .def_prop_ro("optical_path_length", [](py::handle self) { return columnView(self, &rayx::Rays::optical_path_length); })
+        .def_prop_ro("energy", [](py::handle self) { return columnView(self, &rayx::Rays::energy); })
+        .def_prop_ro("order", [](py::handle self) { return columnView(self, &rayx::Rays::order); })
+        .def_prop_ro("object_id", [](py::handle self) { return columnView(self, &rayx::Rays::object_id); })
+        .def_prop_ro("source_id", [](py::handle self) { return columnView(self, &rayx::Rays::source_id); })
+        .def_prop_ro("event_type", [](py::handle self) { return columnView(self, &rayx::Rays::event_type); });
 
-    py::class_<rayx::Beamline>(m, "Beamline")
+    // Weak-referenceable so that the component index of a Beamline can follow its lifetime (see withIndex).
+    py::class_<rayx::Beamline>(m, "Beamline", py::is_weak_referenceable())
         .def_prop_ro("elements", &rayx::Beamline::getElements)
         .def_prop_ro("sources", &rayx::Beamline::getSources)
         .def("trace",
              [](rayx::Beamline& bl, bool sequential, std::optional<uint32_t> seed, std::optional<int> max_events,
-                std::optional<int> device_index, rayx::DeviceConfig::DeviceType device_type) {
-                 // Seed the RNG: a given seed yields deterministic results, otherwise the seed is derived from system time.
-                 if (seed)
-                     rayx::fixSeed(*seed);
-                 else
-                     rayx::randomSeed();
-
-                 // We validate device_index here rather than let enableDeviceByIndex() call RAYX_EXIT,
-                 // which would terminate the Python interpreter.
-                 rayx::DeviceConfig deviceConfig(device_type);
-                 if (deviceConfig.devices.empty())
-                     throw std::runtime_error(
-                         "No compute device available for the requested device_type. Use list_devices() to see the available devices "
-                         "(note: GPU tracing requires a CUDA-enabled build and an NVIDIA GPU).");
-                 if (device_index) {
-                     if (*device_index < 0 || static_cast<size_t>(*device_index) >= deviceConfig.devices.size())
-                         throw std::out_of_range("device_index " + std::to_string(*device_index) +
-                                                 " is out of range; use list_devices() to see the available devices");
-                     deviceConfig.enableDeviceByIndex(static_cast<size_t>(*device_index));
+                std::optional<int> device_index, rayx::DeviceConfig::DeviceType device_type, std::optional<double> time_budget,
+                std::optional<double> deadline, std::optional<uint64_t> batch_size, py::object out) -> py::typed<py::object, TracedRays> {
+                 TracedRays result;
+                 result.sourceRays = stats::sourceRayCount(bl);
+                 if (time_budget || deadline || batch_size) {
+                     // Batched traces are not cached: their seeds differ from a single trace, and they may be cut short.
+                     constexpr uint64_t DEFAULT_BATCHES = 16;
+                     const uint64_t batch = batch_size.value_or(std::max<uint64_t>(1, (result.sourceRays + DEFAULT_BATCHES - 1) / DEFAULT_BATCHES));
+                     if (batch == 0) throw std::invalid_argument("batch_size must be positive.");
+                     result = traceInBatches(*acquireTracer(device_type, device_index), bl, seed, sequential, max_events, batch,
+                                             traceEnd(time_budget, deadline));
                  } else {
-                     deviceConfig.enableBestDevice();
+                     // Only seeded traces are reproducible, so only those go through the trace cache.
+                     auto cache = seed ? trace_cache::current() : std::nullopt;
+                     const auto key = cache ? traceKey(bl, *seed, sequential, max_events, device_type, device_index) : std::nullopt;
+                     if (!key) cache.reset();
+                     std::optional<rayx::Rays> cached = cache ? trace_cache::load(*cache, *key) : std::nullopt;
+                     rayx::Rays& rays = result;
+                     if (cached) {
+                         rays = std::move(*cached);
+                     } else {
+                         rays = traceBeamline(*acquireTracer(device_type, device_index), bl, seed, sequential, max_events);
+                         if (cache) trace_cache::store(*cache, *key, rays);
+                     }
                  }
-
-                 rayx::Tracer tracer = rayx::Tracer(deviceConfig);
-                 rayx::ObjectMask obj_mask = rayx::ObjectMask::all();
-                 rayx::RayAttrMask attr_mask = rayx::RayAttrMask::All;
-                 rayx::Sequential seq = sequential ? rayx::Sequential::Yes : rayx::Sequential::No;
-                 rayx::Rays rays = tracer.trace(bl, seq, obj_mask, attr_mask, max_events, std::nullopt);
-                 return rays;
+                 if (out.is_none()) return py::cast(std::move(result));
+                 storeInto(py::cast<TracedRays&>(out), result);
+                 return out;
              },
              py::arg("sequential") = false, py::arg("seed") = std::optional<uint32_t>(), py::arg("max_events") = std::optional<int>(),
              py::arg("device_index") = std::optional<int>(), py::arg("device_type") = rayx::DeviceConfig::DeviceType::All,
+             py::arg("time_budget") = std::optional<double>(), py::arg("deadline") = std::optional<double>(),
+             py::arg("batch_size") = std::optional<uint64_t>(), py::arg("out") = py::none(),
              "Trace rays through the beamline.\n\n"
              "sequential: if True, rays hit elements in beamline order (sequential tracing); "
              "if False (default), tracing is non-sequential.\n"
@@ -571,20 +1143,354 @@ NB_MODULE(core, m) {
              "device_index: optional index of the compute device to use (see list_devices()); if None (default), the best "
              "available device is chosen automatically.\n"
              "device_type: restrict device selection to a device class (DeviceType.Cpu, DeviceType.Gpu, or DeviceType.All; "
-             "default All).")
-        .def("__getitem__", [](rayx::Beamline& bl, const std::string& name) {
-            for (auto element : bl.getElements()) {
-                if (element->getName() == name) {
-                    return py::cast(element);
+             "default All).\n"
+             "time_budget: optional limit in seconds; deadline: optional Unix time (as time.time()) to finish by.\n"
+             "batch_size: source rays per batch (default: 1/16 of the sources' numberOfRays).\n"
+             "Passing any of time_budget, deadline or batch_size traces in batches, batch k seeded with seed + k. No batch is "
+             "started that is expected to end after the time limit, and Ctrl-C (KeyboardInterrupt) stops the trace after the "
+             "running batch; in both cases the rays of the completed batches are returned. An interrupt during the last batch "
+             "is raised as usual, since no batch was skipped. Path ids are unique across batches. Without any of these three "
+             "arguments the trace runs as one uninterruptible call; Ctrl-C takes effect only once it has finished. "
+             "Rays.source_rays tells how many source rays the result was traced from, to re-weight partial results, and "
+             "Rays.complete whether the trace was cut short.\n"
+             "out: optional Rays to store the result in, which is then returned. Its columns are overwritten in place and only "
+             "grow when a trace records more events than they can hold (see Rays.capacity and Rays.reserve), so reusing one Rays "
+             "across a sweep avoids re-allocating the output and numpy views of it stay valid. Growing while views exist raises "
+             "BufferError.")
+        .def(
+            "sensitivity",
+            [](rayx::Beamline& bl, const std::vector<std::string>& params, std::variant<double, std::vector<double>> step,
+               const std::vector<std::string>& outputs, bool sequential, std::optional<uint32_t> seed, std::optional<int> max_events,
+               std::optional<int> device_index, rayx::DeviceConfig::DeviceType device_type) {
+                std::vector<double> steps;
+                if (auto* h = std::get_if<double>(&step))
+                    steps.assign(params.size(), *h);
+                else
+                    steps = std::get<std::vector<double>>(step);
+                if (steps.size() != params.size())
+                    throw std::invalid_argument("step must be a scalar or have one entry per parameter (" + std::to_string(params.size()) + ").");
+
+                std::vector<ParamRef> refs;
+                refs.reserve(params.size());
+                for (const auto& p : params) refs.push_back(resolveParam(bl, p));
+                const std::vector<stats::StatKey> keys = stats::parseStats(outputs, bl);
+
+                const StudyTracer study(seed, sequential, max_events, device_type, device_index);
+                auto evaluate = [&](std::vector<double>& out) {
+                    const auto beam = study.beamStats(bl);
+                    const uint64_t sourceRays = stats::sourceRayCount(bl);
+                    for (size_t i = 0; i < keys.size(); ++i) out[i] = stats::evaluate(keys[i], beam, sourceRays);
+                };
+
+                // Central differences: J[i][j] = (f_i(p_j + h_j) - f_i(p_j - h_j)) / (2 h_j), stored row-major.
+                std::vector<double> jacobian(keys.size() * refs.size());
+                std::vector<double> plus(keys.size()), minus(keys.size());
+                for (size_t j = 0; j < refs.size(); ++j) {
+                    if (steps[j] == 0.0) throw std::invalid_argument("step for parameter '" + params[j] + "' must be non-zero.");
+                    const double nominal = refs[j].get();
+                    // Parameters are set through Python and may raise, so they are restored here rather than by a destructor.
+                    try {
+                        refs[j].set(nominal + steps[j]);
+                        evaluate(plus);
+                        refs[j].set(nominal - steps[j]);
+                        evaluate(minus);
+                    } catch (...) {
+                        refs[j].set(nominal);
+                        throw;
+                    }
+                    refs[j].set(nominal);
+                    for (size_t i = 0; i < keys.size(); ++i) jacobian[i * refs.size() + j] = (plus[i] - minus[i]) / (2.0 * steps[j]);
                 }
-            }
-            for (auto source : bl.getSources()) {
-                if (source->getName() == name) {
-                    return py::cast(source);
+                return to_numpy_owned<2>(std::move(jacobian), {keys.size(), refs.size()});
+            },
+            py::arg("params"), py::arg("step"), py::arg("outputs"), py::arg("sequential") = false, py::arg("seed") = std::optional<uint32_t>(),
+            py::arg("max_events") = std::optional<int>(), py::arg("device_index") = std::optional<int>(),
+            py::arg("device_type") = rayx::DeviceConfig::DeviceType::All,
+            "Finite-difference Jacobian of beam statistics with respect to design parameters.\n\n"
+            "params: parameters as '<component name>.<attribute>', e.g. 'M1.grazingIncAngle.rad' or 'M1.position.x'.\n"
+            "step: absolute central-difference step, either one value for all parameters or one per parameter.\n"
+            "outputs: statistics as '<stat>@<element name>', e.g. 'rms_x@ImagePlane'. <stat> is transmission, count, "
+            "mean_<q> or rms_<q> with <q> in x, y, z, dx, dy, dz, energy, opl.\n"
+            "All 2 * len(params) traces share one device setup and the same seed (common random numbers), so the Monte Carlo noise "
+            "cancels in the differences. If seed is None, one random seed is drawn and used for all traces.\n"
+            "Returns a float64 array of shape (len(outputs), len(params)). Parameters are restored to their nominal values.")
+        .def(
+            "get_transforms",
+            [](rayx::Beamline& bl) {
+                const auto all = components::all(bl);
+                std::vector<double> positions(all.size() * 4), orientations(all.size() * 16);
+                for (size_t i = 0; i < all.size(); ++i) {
+                    const glm::dvec4 p = components::position(all[i]);
+                    const glm::dmat4x4 o = components::orientation(all[i]);
+                    for (int k = 0; k < 4; ++k) positions[i * 4 + k] = p[k];
+                    // Same row-major convention as the orientation property: numpy [row][col] <-> glm m[col][row].
+                    for (int row = 0; row < 4; ++row)
+                        for (int col = 0; col < 4; ++col) orientations[i * 16 + row * 4 + col] = o[col][row];
                 }
-            }
-            throw std::runtime_error("No element or source with name '" + name + "' found in beamline.");
-        });
+                return std::make_tuple(to_numpy_owned<2>(std::move(positions), {all.size(), 4}),
+                                       to_numpy_owned<3>(std::move(orientations), {all.size(), 4, 4}));
+            },
+            "Positions (N, 4) and orientations (N, 4, 4) of all components as stacked float64 arrays, in the order of "
+            "Beamline.elements followed by Beamline.sources. Orientations follow the convention of the orientation property.")
+        .def(
+            "set_transforms",
+            [](rayx::Beamline& bl, py::ndarray<const double, py::shape<-1, 4>, py::c_contig, py::device::cpu> positions,
+               py::ndarray<const double, py::shape<-1, 4, 4>, py::c_contig, py::device::cpu> orientations) {
+                const auto all = components::all(bl);
+                if (positions.shape(0) != all.size() || orientations.shape(0) != all.size())
+                    throw std::invalid_argument("positions and orientations must have one entry per component (" + std::to_string(all.size()) +
+                                                "), in the order of get_transforms().");
+                const double* p = positions.data();
+                const double* o = orientations.data();
+                for (size_t i = 0; i < all.size(); ++i) {
+                    glm::dmat4x4 orientation;
+                    for (int row = 0; row < 4; ++row)
+                        for (int col = 0; col < 4; ++col) orientation[col][row] = o[i * 16 + row * 4 + col];
+                    components::setPosition(all[i], glm::dvec4(p[i * 4], p[i * 4 + 1], p[i * 4 + 2], p[i * 4 + 3]));
+                    components::setOrientation(all[i], orientation);
+                }
+            },
+            py::arg("positions"), py::arg("orientations"),
+            "Set the poses of all components from stacked arrays as returned by get_transforms().")
+        .def(
+            "misalignment_study",
+            [](rayx::Beamline& bl, size_t n, py::dict tolerances, const std::vector<std::string>& outputs, std::optional<uint32_t> seed,
+               bool sequential, std::optional<int> max_events, std::optional<int> device_index, rayx::DeviceConfig::DeviceType device_type) {
+                std::vector<std::string> names;
+                std::vector<components::Component> comps;
+                std::vector<std::array<double, 6>> sigmas;
+                for (auto [key, value] : tolerances) {
+                    names.push_back(py::cast<std::string>(key));
+                    auto c = lookupComponent(bl, names.back());
+                    if (!c) throw std::invalid_argument("No element or source with name '" + names.back() + "' found in beamline.");
+                    comps.push_back(*c);
+                    sigmas.push_back(py::cast<std::array<double, 6>>(value));
+                }
+                const std::vector<stats::StatKey> keys = stats::parseStats(outputs, bl);
+
+                components::DesignRestore restore;
+                std::vector<components::Pose> nominal;
+                for (const auto& c : comps) nominal.push_back(restore.savePose(c));
+
+                // Misalignments are drawn from their own generator, so the traces can share one seed.
+                std::mt19937_64 gen(drawSeed(seed));
+                std::normal_distribution<double> normal;
+
+                std::vector<double> offsets(n * comps.size() * 6), results(n * keys.size());
+                const StudyTracer study(seed, sequential, max_events, device_type, device_index);
+                for (size_t s = 0; s < n; ++s) {
+                    for (size_t k = 0; k < comps.size(); ++k) {
+                        std::array<double, 6> d;
+                        for (size_t a = 0; a < 6; ++a) d[a] = offsets[(s * comps.size() + k) * 6 + a] = sigmas[k][a] * normal(gen);
+                        components::setPose(comps[k], components::misalign(nominal[k], d));
+                    }
+                    const auto beam = study.beamStats(bl);
+                    const uint64_t sourceRays = stats::sourceRayCount(bl);
+                    for (size_t i = 0; i < keys.size(); ++i) results[s * keys.size() + i] = stats::evaluate(keys[i], beam, sourceRays);
+                }
+
+                py::dict result;
+                result["components"] = names;
+                result["offsets"] = to_numpy_owned<3>(std::move(offsets), {n, comps.size(), 6});
+                result["outputs"] = to_numpy_owned<2>(std::move(results), {n, keys.size()});
+                return result;
+            },
+            py::arg("n"), py::arg("tolerances"), py::arg("outputs"), py::arg("seed") = std::optional<uint32_t>(), py::arg("sequential") = false,
+            py::arg("max_events") = std::optional<int>(), py::arg("device_index") = std::optional<int>(),
+            py::arg("device_type") = rayx::DeviceConfig::DeviceType::All,
+            "Trace n randomly misaligned copies of the beamline and reduce each to beam statistics.\n\n"
+            "tolerances: dict mapping component names to the Gaussian sigmas (dx, dy, dz, rx, ry, rz) of a rigid misalignment "
+            "in the component's own frame (translations in mm along its local axes, rotations in rad about them).\n"
+            "outputs: statistics as '<stat>@<element name>', see sensitivity().\n"
+            "seed: seeds both the misalignment draws and the traces; all traces share one seed (common random numbers).\n"
+            "Returns a dict with 'components' (names, in tolerance order), 'offsets' (n, len(components), 6) and 'outputs' "
+            "(n, len(outputs)). Nominal poses are restored afterwards.")
+        .def(
+            "energy_scan",
+            [](rayx::Beamline& bl, const std::vector<double>& energies, const std::vector<std::string>& design_energy, std::optional<uint32_t> seed,
+               bool sequential, std::optional<int> max_events, std::optional<int> device_index, rayx::DeviceConfig::DeviceType device_type) {
+                const auto sources = bl.getSources();
+                const auto elements = bl.getElements();
+                std::vector<rayx::DesignElement*> tracking;
+                for (const auto& name : design_energy) {
+                    auto it = std::find_if(elements.begin(), elements.end(), [&](auto* e) { return e->getName() == name; });
+                    if (it == elements.end()) throw std::invalid_argument("No element with name '" + name + "' found in beamline.");
+                    tracking.push_back(*it);
+                }
+
+                components::DesignRestore restore;
+                for (auto* source : sources) restore.saveEnergy(source);
+                for (auto* element : tracking) restore.saveDesignEnergy(element);
+
+                // Per-energy, per-element statistics. Quantities not listed here are still reachable through sensitivity().
+                const size_t numEnergies = energies.size(), numElements = elements.size();
+                struct Column {
+                    const char* name;
+                    stats::StatKey key;
+                    std::vector<double> values;
+                };
+                std::vector<Column> columns = {
+                    {"transmission", {stats::StatKey::Kind::Transmission}},
+                    {"count", {stats::StatKey::Kind::Count}},
+                    {"mean_energy", {stats::StatKey::Kind::Mean, stats::Quantity::Energy}},
+                    {"bandwidth", {stats::StatKey::Kind::Rms, stats::Quantity::Energy}},
+                    {"mean_x", {stats::StatKey::Kind::Mean, stats::Quantity::X}},
+                    {"rms_x", {stats::StatKey::Kind::Rms, stats::Quantity::X}},
+                    {"mean_y", {stats::StatKey::Kind::Mean, stats::Quantity::Y}},
+                    {"rms_y", {stats::StatKey::Kind::Rms, stats::Quantity::Y}},
+                    {"mean_z", {stats::StatKey::Kind::Mean, stats::Quantity::Z}},
+                    {"rms_z", {stats::StatKey::Kind::Rms, stats::Quantity::Z}},
+                };
+                for (auto& column : columns) column.values.resize(numEnergies * numElements);
+
+                // The shared seed keeps the curves smooth in energy rather than dominated by Monte Carlo noise.
+                const StudyTracer study(seed, sequential, max_events, device_type, device_index);
+                for (size_t e = 0; e < numEnergies; ++e) {
+                    for (auto* source : sources) source->setEnergy(energies[e]);
+                    for (auto* element : tracking) element->setDesignEnergy(energies[e]);
+                    const auto beam = study.beamStats(bl);
+                    const uint64_t sourceRays = stats::sourceRayCount(bl);
+                    for (auto& column : columns) {
+                        for (size_t object = 0; object < numElements; ++object) {
+                            column.key.object = object;
+                            column.values[e * numElements + object] = stats::evaluate(column.key, beam, sourceRays);
+                        }
+                    }
+                }
+
+                py::dict result;
+                std::vector<std::string> names;
+                for (auto* element : elements) names.push_back(element->getName());
+                result["elements"] = names;
+                result["energy"] = to_numpy_owned<1>(std::vector<double>(energies), {numEnergies});
+                for (auto& column : columns) result[column.name] = to_numpy_owned<2>(std::move(column.values), {numEnergies, numElements});
+                return result;
+            },
+            py::arg("energies"), py::arg("design_energy") = std::vector<std::string>(), py::arg("seed") = std::optional<uint32_t>(),
+            py::arg("sequential") = false, py::arg("max_events") = std::optional<int>(), py::arg("device_index") = std::optional<int>(),
+            py::arg("device_type") = rayx::DeviceConfig::DeviceType::All,
+            "Trace the beamline at each photon energy and reduce every trace to per-element statistics.\n\n"
+            "energies: photon energies in eV; every source's energy is set to each value in turn.\n"
+            "design_energy: names of elements (e.g. gratings) whose designEnergy follows the scan energy.\n"
+            "seed: all energies are traced with the same seed (common random numbers); if None, one random seed is drawn.\n"
+            "Returns a dict with 'energy' (E,), 'elements' (names, M) and float64 arrays of shape (E, M) for 'transmission', "
+            "'count', 'mean_energy', 'bandwidth' (rms energy), and 'mean_<q>' / 'rms_<q>' for q in x, y, z. Source and design "
+            "energies are restored afterwards.")
+        .def(
+            "trace_until",
+            [](rayx::Beamline& bl, py::dict target, uint64_t max_rays, std::optional<uint64_t> batch_size, std::optional<uint32_t> seed,
+               bool sequential, std::optional<int> max_events, std::optional<int> device_index, rayx::DeviceConfig::DeviceType device_type) {
+                std::vector<std::string> specs;
+                std::vector<double> targets;
+                for (auto [key, value] : target) {
+                    specs.push_back(py::cast<std::string>(key));
+                    targets.push_back(py::cast<double>(value));
+                    if (!(targets.back() > 0.0)) throw std::invalid_argument("target for '" + specs.back() + "' must be positive.");
+                }
+                const std::vector<stats::StatKey> keys = stats::parseStats(specs, bl);
+                const size_t numObjects = bl.getElements().size();
+
+                components::RayCountOverride rayCount(bl);
+                uint64_t batch = batch_size.value_or(rayCount.nominalTotal());
+                if (batch == 0) throw std::invalid_argument("batch_size must be positive (or the sources must emit rays).");
+
+                // Only the running per-object statistics are kept; the rays of each batch are dropped once reduced.
+                const auto tracer = acquireTracer(device_type, device_index);
+                // Each batch needs its own random stream: batch k uses baseSeed + k. Without a seed the base is drawn once,
+                // since reseeding from the clock per batch can repeat a stream for batches started within its resolution.
+                const uint32_t baseSeed = drawSeed(seed);
+                std::vector<stats::BeamStats> beam(numObjects);
+                std::vector<double> values(keys.size()), errors(keys.size());
+                uint64_t emitted = 0, batches = 0;
+                bool converged = false;
+                while (!converged && emitted < max_rays) {
+                    const uint64_t n = rayCount.set(std::min(batch, max_rays - emitted));
+                    if (n == 0) break;
+                    stats::accumulate(traceBeamline(*tracer, bl, baseSeed + static_cast<uint32_t>(batches), sequential, max_events), beam);
+                    emitted += n;
+                    ++batches;
+
+                    converged = true;
+                    for (size_t i = 0; i < keys.size(); ++i) {
+                        values[i] = stats::evaluate(keys[i], beam, emitted);
+                        errors[i] = stats::uncertainty(keys[i], beam, emitted);
+                        converged = converged && errors[i] <= targets[i];
+                    }
+                    // Doubling keeps the number of traces logarithmic in the rays finally needed.
+                    batch *= 2;
+                }
+
+                py::dict result, valueDict, errorDict;
+                for (size_t i = 0; i < keys.size(); ++i) {
+                    valueDict[specs[i].c_str()] = values[i];
+                    errorDict[specs[i].c_str()] = errors[i];
+                }
+                result["values"] = valueDict;
+                result["errors"] = errorDict;
+                result["rays"] = emitted;
+                result["batches"] = batches;
+                result["converged"] = converged;
+                return result;
+            },
+            py::arg("target"), py::arg("max_rays"), py::arg("batch_size") = std::optional<uint64_t>(), py::arg("seed") = std::optional<uint32_t>(),
+            py::arg("sequential") = false, py::arg("max_events") = std::optional<int>(), py::arg("device_index") = std::optional<int>(),
+            py::arg("device_type") = rayx::DeviceConfig::DeviceType::All,
+            "Trace in growing batches until every statistic reaches its target precision.\n\n"
+            "target: dict mapping statistics ('<stat>@<element name>', see sensitivity()) to the largest acceptable one-sigma "
+            "Monte Carlo uncertainty, e.g. {'transmission@ImagePlane': 1e-3, 'rms_x@ImagePlane': 0.01}.\n"
+            "max_rays: upper bound on the total number of source rays.\n"
+            "batch_size: source rays in the first batch (default: the sources' numberOfRays); every further batch is twice as "
+            "large. Rays are split between sources in proportion to their numberOfRays.\n"
+            "seed: if given, batch k is traced with seed + k, so the run is reproducible.\n"
+            "Statistics are accumulated natively across batches (Welford) without keeping the rays. Returns a dict with "
+            "'values' and 'errors' (dicts keyed like target), 'rays' (source rays used), 'batches' and 'converged'. The "
+            "sources' numberOfRays are restored afterwards.")
+        // Components are indexed by name through a cached hash map, and by position / slice in the order of elements
+        // followed by sources. Components are returned as views that keep the Beamline alive; nanobind hands out the
+        // existing Python object for a component while one is alive, so repeated lookups yield the same object.
+        // A Beamline is a sequence that also supports lookup by name, not a Mapping: iterating yields the components,
+        // like a list, while keys() / items() give their names.
+        .def("__getitem__", &getComponent, py::arg("name"), py::rv_policy::reference_internal,
+             "The component with the given name. Raises ComponentNotFoundError (a KeyError) if there is none.")
+        .def(
+            "__getitem__",
+            [](rayx::Beamline& bl, int64_t i) {
+                return withIndex(bl, [&](components::Index& index) {
+                    const auto& all = index.all();
+                    const int64_t n = static_cast<int64_t>(all.size());
+                    if (i < -n || i >= n) throw std::out_of_range("Beamline index " + std::to_string(i) + " out of range for " + std::to_string(n) + " components");
+                    return all[static_cast<size_t>(i < 0 ? i + n : i)];
+                });
+            },
+            py::arg("index"), py::rv_policy::reference_internal)
+        .def(
+            "__getitem__",
+            [](rayx::Beamline& bl, py::slice slice) {
+                const auto all = withIndex(bl, [](components::Index& index) { return index.all(); });
+                auto [start, stop, step, length] = slice.compute(all.size());
+                std::vector<components::Component> out;
+                out.reserve(length);
+                for (size_t k = 0; k < length; ++k, start += step) out.push_back(all[static_cast<size_t>(start)]);
+                return out;
+            },
+            py::arg("slice"), py::rv_policy::reference_internal)
+        .def("__len__", [](rayx::Beamline& bl) { return withIndex(bl, [](components::Index& index) { return index.all().size(); }); })
+        .def("__contains__", [](rayx::Beamline& bl, const std::string& name) { return lookupComponent(bl, name).has_value(); }, py::arg("name"))
+        .def(
+            "keys", [](rayx::Beamline& bl) { return withIndex(bl, [&](components::Index& index) { return index.names(bl); }); },
+            "Names of all components, elements first, then sources.")
+        .def(
+            "items",
+            [](rayx::Beamline& bl) {
+                return withIndex(bl, [&](components::Index& index) {
+                    auto names = index.names(bl);
+                    std::vector<std::pair<std::string, components::Component>> out;
+                    out.reserve(names.size());
+                    for (size_t k = 0; k < names.size(); ++k) out.emplace_back(std::move(names[k]), index.all()[k]);
+                    return out;
+                });
+            },
+            py::rv_policy::reference_internal, "(name, component) pairs of all components, elements first, then sources.");
 
     m.def("import_beamline", [](std::string path) { return rayx::importBeamline(path); }, "Import a beamline from an RML file", py::arg("path"));
 
@@ -618,8 +1524,55 @@ NB_MODULE(core, m) {
         "device_type: restrict the listing to a device class (DeviceType.Cpu, DeviceType.Gpu, or DeviceType.All; default All).\n"
         "Note: GPU devices only appear in a CUDA-enabled build running on a machine with an NVIDIA GPU.");
 
-    m.def("fix_seed", &rayx::fixSeed, py::arg("seed") = rayx::FIXED_SEED,
-          "Fix the global RNG seed so that subsequent traces are deterministic. Defaults to the canonical fixed test seed.");
-    m.def("random_seed", &rayx::randomSeed, "Seed the global RNG randomly (based on system time).");
+    m.def(
+        "set_tracer_cache",
+        [](bool enabled) {
+            keepTracers().store(enabled);
+            if (!enabled) releaseTracers();
+        },
+        py::arg("enabled"),
+        "Keep one Tracer per device selection across calls (True), or build a Tracer for every call and release it "
+        "afterwards (False, the default). Keeping Tracers saves the device setup on every trace after the first, but each "
+        "kept Tracer holds device memory sized by the largest trace it ran until clear_tracer_cache() or "
+        "set_tracer_cache(False).");
+    m.def("clear_tracer_cache", &releaseTracers,
+          "Release the Tracers kept by set_tracer_cache(True) and the device memory they hold; the next trace builds a new "
+          "one.");
+
+    m.def(
+        "set_trace_cache",
+        [](std::optional<std::string> dir, uint64_t max_bytes) {
+            if (dir)
+                trace_cache::configure(trace_cache::Config{*dir, max_bytes});
+            else
+                trace_cache::configure(std::nullopt);
+        },
+        py::arg("dir").none(), py::arg("max_bytes") = uint64_t{1} << 30,
+        "Enable an on-disk cache of trace results in dir, or disable it with None (the default state).\n"
+        "While enabled, Beamline.trace(seed=...) with a fixed seed first looks up a content hash of the beamline's design "
+        "parameters (including the contents of referenced profile files), the seed, sequential, max_events, the device "
+        "selection and the loaded rayx binaries; on a hit the stored Rays are returned without tracing. Unseeded traces, "
+        "and beamlines with ray list sources or energy distributions read from a file, are never cached.\n"
+        "max_bytes: size limit of the cache directory; least recently used entries are evicted beyond it.\n"
+        "Several processes may share one cache directory: entries are written atomically and eviction tolerates "
+        "concurrent removal.");
+
+    m.def(
+        "fix_seed",
+        [](uint32_t seed) {
+            py::gil_scoped_release release;
+            std::lock_guard lock(engineMutex());
+            rayx::fixSeed(seed);
+        },
+        py::arg("seed") = rayx::FIXED_SEED,
+        "Fix the global RNG seed so that subsequent traces are deterministic. Defaults to the canonical fixed test seed.");
+    m.def(
+        "random_seed",
+        [] {
+            py::gil_scoped_release release;
+            std::lock_guard lock(engineMutex());
+            rayx::randomSeed();
+        },
+        "Seed the global RNG randomly (based on system time).");
     m.attr("FIXED_SEED") = rayx::FIXED_SEED;
 }
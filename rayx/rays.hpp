@@ -0,0 +1,84 @@
+#pragma once
+
+#include <Tracer/Tracer.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace ray_columns {
+
+// Calls f(name, column) for every attribute column of `rays`, in the order they are exposed to Python.
+template <typename R, typename F>
+void forEach(R& rays, F&& f) {
+    f("path_id", rays.path_id);
+    f("path_event_id", rays.path_event_id);
+    f("position_x", rays.position_x);
+    f("position_y", rays.position_y);
+    f("position_z", rays.position_z);
+    f("direction_x", rays.direction_x);
+    f("direction_y", rays.direction_y);
+    f("direction_z", rays.direction_z);
+    f("electric_field_x", rays.electric_field_x);
+    f("electric_field_y", rays.electric_field_y);
+    f("electric_field_z", rays.electric_field_z);
+    f("optical_path_length", rays.optical_path_length);
+    f("energy", rays.energy);
+    f("order", rays.order);
+    f("object_id", rays.object_id);
+    f("source_id", rays.source_id);
+    f("event_type", rays.event_type);
+}
+
+// Calls f(name, a_column, b_column) for every pair of corresponding columns of `a` and `b`.
+template <typename A, typename B, typename F>
+void zip(A& a, B& b, F&& f) {
+    f("path_id", a.path_id, b.path_id);
+    f("path_event_id", a.path_event_id, b.path_event_id);
+    f("position_x", a.position_x, b.position_x);
+    f("position_y", a.position_y, b.position_y);
+    f("position_z", a.position_z, b.position_z);
+    f("direction_x", a.direction_x, b.direction_x);
+    f("direction_y", a.direction_y, b.direction_y);
+    f("direction_z", a.direction_z, b.direction_z);
+    f("electric_field_x", a.electric_field_x, b.electric_field_x);
+    f("electric_field_y", a.electric_field_y, b.electric_field_y);
+    f("electric_field_z", a.electric_field_z, b.electric_field_z);
+    f("optical_path_length", a.optical_path_length, b.optical_path_length);
+    f("energy", a.energy, b.energy);
+    f("order", a.order, b.order);
+    f("object_id", a.object_id, b.object_id);
+    f("source_id", a.source_id, b.source_id);
+    f("event_type", a.event_type, b.event_type);
+}
+
+// Number of recorded events.
+inline size_t size(const rayx::Rays& rays) { return rays.path_id.size(); }
+
+// Number of events `rays` can hold without reallocating any column.
+inline size_t capacity(const rayx::Rays& rays) {
+    size_t cap = static_cast<size_t>(-1);
+    forEach(rays, [&](const char*, const auto& column) { cap = std::min(cap, column.capacity()); });
+    return cap;
+}
+
+inline void reserve(rayx::Rays& rays, size_t n) {
+    forEach(rays, [&](const char*, auto& column) { column.reserve(n); });
+}
+
+// Copies the events of `src` into the existing storage of `dst`; a column only reallocates if it cannot hold them.
+inline void copyInto(rayx::Rays& dst, const rayx::Rays& src) {
+    zip(dst, src, [](const char*, auto& d, const auto& s) { d.assign(s.begin(), s.end()); });
+}
+
+// Appends the events of `src` to `dst`. The path ids of `src` are shifted by `pathOffset`, so that the paths of rays traced
+// separately (e.g. in batches) stay distinct.
+inline void append(rayx::Rays& dst, const rayx::Rays& src, uint64_t pathOffset) {
+    const size_t begin = size(dst);
+    zip(dst, src, [](const char*, auto& d, const auto& s) { d.insert(d.end(), s.begin(), s.end()); });
+    using PathId = typename decltype(dst.path_id)::value_type;
+    for (size_t i = begin; i < dst.path_id.size(); ++i) dst.path_id[i] += static_cast<PathId>(pathOffset);
+}
+
+}  // namespace ray_columns
@@ -5,9 +5,11 @@
 #include <nanobind/stl/variant.h>
 
 #include <array>
+#include <atomic>
 #include <concepts>
 #include <functional>
 #include <tuple>
+#include <utility>
 
 namespace py = nanobind;
 
@@ -94,10 +96,27 @@ struct pytype_t<rayx::Variant<V, Ts...>> {
     using value_t = std::variant<Ref<Ts>...>;
 };
 
+// Getters of nested structures and variants return a Ref that refers back to `self`; keep_alive ties the lifetime of
+// `self` to the returned Ref so the reference can never dangle. Other getters return plain Python values (float, str,
+// ...), which cannot be weak-referenced and thus cannot carry a keep_alive, so they are bound without one.
+template <typename M, typename C, typename Getter, typename Setter>
+void def_prop(C& cls, const char* name, Getter&& getter, Setter&& setter) {
+    if constexpr (Structure<M> || Variant<M>)
+        cls.def_prop_rw(name, std::forward<Getter>(getter), std::forward<Setter>(setter), py::for_getter(py::keep_alive<0, 1>()));
+    else
+        cls.def_prop_rw(name, std::forward<Getter>(getter), std::forward<Setter>(setter));
+}
+
+// Calls info<S>::on_set(self, name) after the property `name` of S was set from Python, if info<S> declares it.
+template <typename S>
+void notify_set(S& self, const char* name) {
+    if constexpr (requires { info<S>::on_set(self, name); }) info<S>::on_set(self, name);
+}
+
 template <typename S, typename M>
 void bind(py::class_<S>& cls, const field_info<S, M>& field) {
-    cls.def_prop_rw(
-        field.name,
+    def_prop<M>(
+        cls, field.name,
         [field](S& self) -> py::typed<py::object, typename pytype_t<M>::value_t> {
             if constexpr (Structure<M>) {
                 return py::cast(Ref<M>{[&self, field]() { return self.*(field.member); }, [&self, field](M value) { self.*(field.member) = value; }});
@@ -111,13 +130,16 @@ void bind(py::class_<S>& cls, const field_info<S, M>& field) {
             }
             return py::cast(self.*(field.member));
         },
-        [field](S& self, M m) { self.*(field.member) = m; });
+        [field](S& self, M m) {
+            self.*(field.member) = m;
+            notify_set(self, field.name);
+        });
 }
 
 template <typename S, typename M>
 void bind(py::class_<S>& cls, const prop_info<S, M>& prop) {
-    cls.def_prop_rw(
-        prop.name,
+    def_prop<M>(
+        cls, prop.name,
         [prop](S& self) -> py::typed<py::object, typename pytype_t<M>::value_t> {
             if constexpr (Structure<M>) {
                 return py::cast(
@@ -138,13 +160,16 @@ void bind(py::class_<S>& cls, const prop_info<S, M>& prop) {
             }
             return py::cast((self.*(prop.getter))());
         },
-        [prop](S& self, M m) { (self.*(prop.setter))(m); });
+        [prop](S& self, M m) {
+            (self.*(prop.setter))(m);
+            notify_set(self, prop.name);
+        });
 }
 
 template <typename S, typename M>
 void bind_ref(py::class_<Ref<S>>& cls, const field_info<S, M>& field) {
-    cls.def_prop_rw(
-        field.name,
+    def_prop<M>(
+        cls, field.name,
         [field](Ref<S>& self) -> py::typed<py::object, typename pytype_t<M>::value_t> {
             if constexpr (Structure<M>) {
                 return py::cast(Ref<M>{[&self, field]() { return self.get().*(field.member); },
@@ -180,8 +205,8 @@ void bind_ref(py::class_<Ref<S>>& cls, const field_info<S, M>& field) {
 
 template <typename S, typename M>
 void bind_ref(py::class_<Ref<S>>& cls, const prop_info<S, M>& prop) {
-    cls.def_prop_rw(
-        prop.name,
+    def_prop<M>(
+        cls, prop.name,
         [prop](Ref<S>& self) -> py::typed<py::object, typename pytype_t<M>::value_t> {
             if constexpr (Structure<M>) {
                 return py::cast(Ref<M>{[&self, prop]() {
@@ -223,6 +248,14 @@ void bind_ref(py::class_<Ref<S>>& cls, const prop_info<S, M>& prop) {
 
 // de.cutout.width = 2.0
 
+// Returns true for the first call per Tag only. Registration may be reached from several threads when the module is
+// imported on a free-threaded interpreter, so a plain static bool is not enough.
+template <typename Tag>
+bool first_registration() {
+    static std::atomic_flag done = ATOMIC_FLAG_INIT;
+    return !done.test_and_set();
+}
+
 template <typename T>
 void register_type(py::module_& m) {
     static_assert(false, "type not registered");
@@ -244,9 +277,7 @@ void register_type(py::module_& m);
 
 template <Structure T>
 void register_type(py::module_& m) {
-    static bool registered = false;
-    if (registered) return;
-    registered = true;
+    if (!first_registration<T>()) return;
 
     const char* name = info<T>::type_name;
 
@@ -276,9 +307,7 @@ void register_type(py::module_& m) {
 
 template <typename T, typename U>
 void register_alternative(py::module_& m, py::class_<T> cls) {
-    static bool registered = false;
-    if (registered) return;
-    registered = true;
+    if (!first_registration<std::pair<T, U>>()) return;
 
     register_type<U>(m);
 
@@ -292,9 +321,7 @@ void register_all_alternatives(py::module_& m, py::class_<T> cls, rayx::Variant<
 
 template <Variant T>
 void register_type(py::module_& m) {
-    static bool registered = false;
-    if (registered) return;
-    registered = true;
+    if (!first_registration<T>()) return;
 
     const char* name = info<T>::type_name;
 
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <Beamline/Beamline.h>
+#include <Tracer/Tracer.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stats {
+
+// Running mean / variance of a scalar (Welford). Two accumulators can be merged (Chan et al.), so statistics of
+// separately traced batches combine exactly without keeping the rays around.
+struct RunningStats {
+    uint64_t count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+
+    void add(double x) {
+        ++count;
+        const double delta = x - mean;
+        mean += delta / static_cast<double>(count);
+        m2 += delta * (x - mean);
+    }
+
+    void merge(const RunningStats& other) {
+        if (other.count == 0) return;
+        if (count == 0) {
+            *this = other;
+            return;
+        }
+        const double n = static_cast<double>(count + other.count);
+        const double delta = other.mean - mean;
+        mean += delta * static_cast<double>(other.count) / n;
+        m2 += other.m2 + delta * delta * static_cast<double>(count) * static_cast<double>(other.count) / n;
+        count += other.count;
+    }
+
+    // Root mean square deviation from the centroid, i.e. the population standard deviation.
+    double rms() const { return count > 0 ? std::sqrt(m2 / static_cast<double>(count)) : 0.0; }
+};
+
+// Per-ray quantities accumulated for every object.
+enum class Quantity { X, Y, Z, DirX, DirY, DirZ, Energy, PathLength, Count_ };
+constexpr size_t NUM_QUANTITIES = static_cast<size_t>(Quantity::Count_);
+
+// Beam statistics of all rays that hit one object.
+struct BeamStats {
+    std::array<RunningStats, NUM_QUANTITIES> quantities;
+
+    uint64_t hits() const { return quantities[0].count; }
+    const RunningStats& operator[](Quantity q) const { return quantities[static_cast<size_t>(q)]; }
+
+    void add(const rayx::Rays& rays, size_t i) {
+        const double values[NUM_QUANTITIES] = {rays.position_x[i],  rays.position_y[i],  rays.position_z[i], rays.direction_x[i],
+                                               rays.direction_y[i], rays.direction_z[i], rays.energy[i],     rays.optical_path_length[i]};
+        for (size_t q = 0; q < NUM_QUANTITIES; ++q) quantities[q].add(values[q]);
+    }
+
+    void merge(const BeamStats& other) {
+        for (size_t q = 0; q < NUM_QUANTITIES; ++q) quantities[q].merge(other.quantities[q]);
+    }
+};
+
+// Accumulates the statistics of every HitElement event in `rays` into `out`, indexed by object id.
+inline void accumulate(const rayx::Rays& rays, std::vector<BeamStats>& out) {
+    const size_t n = rays.object_id.size();
+    for (size_t i = 0; i < n; ++i) {
+        if (rays.event_type[i] != rayx::EventType::HitElement) continue;
+        const auto object = static_cast<int64_t>(rays.object_id[i]);
+        if (object < 0 || static_cast<size_t>(object) >= out.size()) continue;
+        out[static_cast<size_t>(object)].add(rays, i);
+    }
+}
+
+inline std::vector<BeamStats> collect(const rayx::Rays& rays, size_t numObjects) {
+    std::vector<BeamStats> out(numObjects);
+    accumulate(rays, out);
+    return out;
+}
+
+// A scalar beam statistic at one object, written as "<stat>@<element name>", e.g. "rms_x@ImagePlane".
+//
+// <stat> is "transmission" (hits / emitted source rays), "count" (hits), or "mean_<q>" / "rms_<q>" where <q> is one of
+// x, y, z (position), dx, dy, dz (direction), energy or opl (optical path length).
+struct StatKey {
+    enum class Kind { Transmission, Count, Mean, Rms };
+
+    Kind kind;
+    Quantity quantity = Quantity::X;
+    size_t object;
+};
+
+inline StatKey parseStat(const std::string& spec, rayx::Beamline& bl) {
+    const auto at = spec.find('@');
+    if (at == std::string::npos) throw std::invalid_argument("Statistic '" + spec + "' must have the form '<stat>@<element name>'.");
+    const std::string stat = spec.substr(0, at);
+    const std::string element = spec.substr(at + 1);
+
+    StatKey key{};
+    const auto elements = bl.getElements();
+    size_t object = 0;
+    for (; object < elements.size(); ++object)
+        if (elements[object]->getName() == element) break;
+    if (object == elements.size()) throw std::invalid_argument("No element with name '" + element + "' found in beamline.");
+    key.object = object;
+
+    if (stat == "transmission") {
+        key.kind = StatKey::Kind::Transmission;
+        return key;
+    }
+    if (stat == "count") {
+        key.kind = StatKey::Kind::Count;
+        return key;
+    }
+
+    std::string quantity;
+    if (stat.starts_with("mean_")) {
+        key.kind = StatKey::Kind::Mean;
+        quantity = stat.substr(5);
+    } else if (stat.starts_with("rms_")) {
+        key.kind = StatKey::Kind::Rms;
+        quantity = stat.substr(4);
+    } else {
+        throw std::invalid_argument("Unknown statistic '" + stat + "'; expected transmission, count, mean_<q> or rms_<q>.");
+    }
+
+    static constexpr std::array<const char*, NUM_QUANTITIES> names = {"x", "y", "z", "dx", "dy", "dz", "energy", "opl"};
+    for (size_t q = 0; q < NUM_QUANTITIES; ++q) {
+        if (quantity == names[q]) {
+            key.quantity = static_cast<Quantity>(q);
+            return key;
+        }
+    }
+    throw std::invalid_argument("Unknown quantity '" + quantity + "' in statistic '" + spec + "'; expected x, y, z, dx, dy, dz, energy or opl.");
+}
+
+inline std::vector<StatKey> parseStats(const std::vector<std::string>& specs, rayx::Beamline& bl) {
+    std::vector<StatKey> keys;
+    keys.reserve(specs.size());
+    for (const auto& spec : specs) keys.push_back(parseStat(spec, bl));
+    return keys;
+}
+
+// Total number of rays emitted by all sources of the beamline in one trace.
+inline uint64_t sourceRayCount(rayx::Beamline& bl) {
+    uint64_t total = 0;
+    for (auto source : bl.getSources()) total += static_cast<uint64_t>(source->getNumberOfRays());
+    return total;
+}
+
+inline double evaluate(const StatKey& key, const std::vector<BeamStats>& beam, uint64_t sourceRays) {
+    const BeamStats& s = beam[key.object];
+    switch (key.kind) {
+        case StatKey::Kind::Transmission: return sourceRays > 0 ? static_cast<double>(s.hits()) / static_cast<double>(sourceRays) : 0.0;
+        case StatKey::Kind::Count: return static_cast<double>(s.hits());
+        case StatKey::Kind::Mean: return s[key.quantity].mean;
+        case StatKey::Kind::Rms: return s[key.quantity].rms();
+    }
+    return 0.0;
+}
+
+// One-sigma Monte Carlo uncertainty of evaluate(): binomial for transmission, Poisson for count, standard error for
+// means, and the large-sample (Gaussian) standard error sigma / sqrt(2 (n - 1)) for rms values. Infinite while a value
+// cannot be estimated yet.
+inline double uncertainty(const StatKey& key, const std::vector<BeamStats>& beam, uint64_t sourceRays) {
+    constexpr double inf = std::numeric_limits<double>::infinity();
+    const BeamStats& s = beam[key.object];
+    const double hits = static_cast<double>(s.hits());
+    switch (key.kind) {
+        case StatKey::Kind::Transmission: {
+            if (sourceRays == 0) return inf;
+            const double n = static_cast<double>(sourceRays);
+            const double p = hits / n;
+            // With no hits (or all hits) use the rule-of-three bound rather than claiming zero uncertainty.
+            if (s.hits() == 0 || s.hits() == sourceRays) return 3.0 / n;
+            return std::sqrt(p * (1.0 - p) / n);
+        }
+        case StatKey::Kind::Count: return std::sqrt(hits);
+        case StatKey::Kind::Mean: return s.hits() > 1 ? s[key.quantity].rms() / std::sqrt(hits) : inf;
+        case StatKey::Kind::Rms: return s.hits() > 2 ? s[key.quantity].rms() / std::sqrt(2.0 * (hits - 1.0)) : inf;
+    }
+    return inf;
+}
+
+}  // namespace stats
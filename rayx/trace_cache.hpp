@@ -0,0 +1,312 @@
+#pragma once
+
+#include <Tracer/Tracer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "rays.hpp"
+#include "reflection.hpp"
+
+#if !defined(_WIN32)
+#include <dlfcn.h>
+#include <unistd.h>
+#endif
+
+#ifndef RAYXPY_VERSION
+#define RAYXPY_VERSION "dev"
+#endif
+
+namespace trace_cache {
+
+// 128-bit FNV-1a over a canonical byte encoding of the hashed values.
+class Hasher {
+  public:
+    void bytes(const void* data, size_t size) {
+        const auto* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            m_state ^= p[i];
+            m_state *= PRIME;
+        }
+    }
+    void string(std::string_view s) {
+        u64(s.size());
+        bytes(s.data(), s.size());
+    }
+    void u64(uint64_t v) { bytes(&v, sizeof(v)); }
+
+    std::string hex() const {
+        static constexpr char digits[] = "0123456789abcdef";
+        std::string out(32, '0');
+        unsigned __int128 v = m_state;
+        for (int i = 31; i >= 0; --i, v >>= 4) out[static_cast<size_t>(i)] = digits[static_cast<size_t>(v & 0xf)];
+        return out;
+    }
+
+  private:
+    static constexpr unsigned __int128 PRIME = (static_cast<unsigned __int128>(1) << 88) + 0x13b;
+    unsigned __int128 m_state = (static_cast<unsigned __int128>(0x6c62272e07bb0142ULL) << 64) | 0x62b821756295c58dULL;
+};
+
+template <typename T>
+void hashValue(Hasher& h, const T& value);
+
+template <typename S, typename M>
+M fieldValue(const S& s, const reflect::field_info<S, M>& field) {
+    return s.*(field.member);
+}
+
+template <typename S, typename M>
+M fieldValue(const S& s, const reflect::prop_info<S, M>& prop) {
+    return (s.*(prop.getter))();
+}
+
+// Hashes every field listed in the reflection table of S, by name. Parameters an element does not have make their
+// getter throw; they are hashed as "unset" so that the key still covers everything that is set.
+template <typename S>
+void hashFields(Hasher& h, const S& s) {
+    h.string(reflect::info<S>::type_name);
+    std::apply(
+        [&](const auto&... field) {
+            (([&] {
+                 h.string(field.name);
+                 try {
+                     hashValue(h, fieldValue(s, field));
+                 } catch (const std::exception&) {
+                     h.string("<unset>");
+                 }
+             })(),
+             ...);
+        },
+        reflect::info<S>::fields);
+}
+
+template <typename T>
+void hashValue(Hasher& h, const T& value) {
+    if constexpr (reflect::Structure<T>) {
+        hashFields(h, value);
+    } else if constexpr (reflect::Variant<T>) {
+        value.visit([&]<typename U>(U&& alternative) {
+            using A = std::remove_cvref_t<U>;
+            if constexpr (reflect::Structure<A>)
+                hashFields(h, alternative);
+            else
+                hashValue(h, alternative);
+        });
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        h.string(value);
+    } else if constexpr (std::is_same_v<T, std::filesystem::path>) {
+        // Must precede the range branch: a path is a range of paths, which would recurse without end.
+        h.string(value.generic_string());
+    } else if constexpr (std::ranges::range<T>) {
+        h.u64(static_cast<uint64_t>(std::ranges::distance(value)));
+        for (const auto& item : value) hashValue(h, item);
+    } else if constexpr (std::is_same_v<T, glm::dmat4x4>) {
+        for (int col = 0; col < 4; ++col)
+            for (int row = 0; row < 4; ++row) hashValue(h, value[col][row]);
+    } else if constexpr (std::is_enum_v<T>) {
+        h.u64(static_cast<uint64_t>(value));
+    } else if constexpr (std::is_floating_point_v<T>) {
+        const double d = static_cast<double>(value);
+        h.u64(std::bit_cast<uint64_t>(d));
+    } else {
+        static_assert(std::is_arithmetic_v<T>, "trace_cache::hashValue: unsupported field type");
+        h.u64(static_cast<uint64_t>(value));
+    }
+}
+
+// Hashes the contents of a file referenced by a design parameter, so that editing the file changes the key.
+inline void hashFile(Hasher& h, const std::filesystem::path& path) {
+    h.string(path.generic_string());
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        h.string("<missing>");
+        return;
+    }
+    std::vector<char> buffer(1 << 16);
+    uint64_t total = 0;
+    while (in.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || in.gcount() > 0) {
+        h.bytes(buffer.data(), static_cast<size_t>(in.gcount()));
+        total += static_cast<uint64_t>(in.gcount());
+    }
+    h.u64(total);
+}
+
+// Identifies the binaries that compute a trace: the build version (see CMakeLists.txt) plus path, size and modification
+// time of the shared objects containing `symbols`. Any rebuild of this module or of a shared rayx-core thus changes
+// every key, even when the version string does not. Computed once per process.
+inline const std::string& buildId(std::initializer_list<const void*> symbols) {
+    static const std::string id = [&] {
+        Hasher h;
+        h.string(RAYXPY_VERSION);
+#if !defined(_WIN32)
+        for (const void* symbol : symbols) {
+            Dl_info info;
+            std::error_code ec;
+            if (::dladdr(symbol, &info) == 0 || info.dli_fname == nullptr) {
+                h.string("<unknown>");
+                continue;
+            }
+            const std::filesystem::path file(info.dli_fname);
+            h.string(file.generic_string());
+            h.u64(std::filesystem::file_size(file, ec));
+            h.u64(static_cast<uint64_t>(std::filesystem::last_write_time(file, ec).time_since_epoch().count()));
+        }
+#else
+        (void)symbols;
+        h.string(__DATE__ " " __TIME__);
+#endif
+        return h.hex();
+    }();
+    return id;
+}
+
+struct Config {
+    std::filesystem::path dir;
+    uint64_t maxBytes;
+};
+
+inline std::mutex& configMutex() {
+    static std::mutex m;
+    return m;
+}
+
+inline std::optional<Config>& config() {
+    static std::optional<Config> c;
+    return c;
+}
+
+inline std::optional<Config> current() {
+    std::lock_guard lock(configMutex());
+    return config();
+}
+
+inline void configure(std::optional<Config> c) {
+    if (c) std::filesystem::create_directories(c->dir);
+    std::lock_guard lock(configMutex());
+    config() = std::move(c);
+}
+
+constexpr char MAGIC[8] = {'R', 'A', 'Y', 'X', 'T', 'R', 'C', '1'};
+constexpr const char* EXTENSION = ".rays";
+
+inline std::filesystem::path entryPath(const Config& c, const std::string& key) { return c.dir / (key + EXTENSION); }
+
+// Reads a cached entry, or returns nullopt on a miss. Entries are only ever created by an atomic rename, so a reader
+// sees either a complete file or none; a file that still fails validation is treated as a miss. A hit refreshes the
+// entry's modification time, which is what eviction orders by (least recently used first).
+inline std::optional<rayx::Rays> load(const Config& c, const std::string& key) {
+    const auto path = entryPath(c, key);
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return std::nullopt;
+
+    char magic[sizeof(MAGIC)];
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) return std::nullopt;
+
+    rayx::Rays rays;
+    bool ok = true;
+    ray_columns::forEach(rays, [&](const char* name, auto& column) {
+        using T = typename std::remove_cvref_t<decltype(column)>::value_type;
+        uint64_t nameSize = 0, bytes = 0;
+        if (!ok || !in.read(reinterpret_cast<char*>(&nameSize), sizeof(nameSize)) || nameSize != std::strlen(name)) {
+            ok = false;
+            return;
+        }
+        std::string stored(nameSize, '\0');
+        if (!in.read(stored.data(), static_cast<std::streamsize>(nameSize)) || stored != name ||
+            !in.read(reinterpret_cast<char*>(&bytes), sizeof(bytes)) || bytes % sizeof(T) != 0) {
+            ok = false;
+            return;
+        }
+        column.resize(bytes / sizeof(T));
+        if (!in.read(reinterpret_cast<char*>(column.data()), static_cast<std::streamsize>(bytes))) ok = false;
+    });
+    if (!ok) return std::nullopt;
+
+    std::error_code ec;
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+    return rays;
+}
+
+// Removes least recently used entries until the cache holds at most maxBytes. Several processes may evict at once;
+// entries that disappear underneath us are simply skipped.
+inline void evict(const Config& c) {
+    struct Entry {
+        std::filesystem::path path;
+        std::filesystem::file_time_type time;
+        uint64_t size;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    std::error_code ec;
+    for (const auto& e : std::filesystem::directory_iterator(c.dir, ec)) {
+        if (e.path().extension() != EXTENSION) continue;
+        std::error_code statEc;
+        const uint64_t size = e.file_size(statEc);
+        const auto time = e.last_write_time(statEc);
+        if (statEc) continue;
+        entries.push_back({e.path(), time, size});
+        total += size;
+    }
+    if (total <= c.maxBytes) return;
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.time < b.time; });
+    for (const auto& e : entries) {
+        if (total <= c.maxBytes) break;
+        std::error_code rmEc;
+        std::filesystem::remove(e.path, rmEc);
+        total -= e.size;
+    }
+}
+
+// Writes an entry to a private temporary file and renames it into place, which is atomic on POSIX file systems, so
+// concurrent writers of the same key are harmless and readers never observe a partial file.
+inline void store(const Config& c, const std::string& key, rayx::Rays& rays) {
+    static std::atomic<uint64_t> counter{0};
+#if !defined(_WIN32)
+    const auto pid = static_cast<uint64_t>(::getpid());
+#else
+    const uint64_t pid = 0;
+#endif
+    const auto tmp = c.dir / (key + ".tmp." + std::to_string(pid) + "." + std::to_string(counter++) + "." + std::to_string(std::random_device{}()));
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return;
+        out.write(MAGIC, sizeof(MAGIC));
+        ray_columns::forEach(rays, [&](const char* name, const auto& column) {
+            using T = typename std::remove_cvref_t<decltype(column)>::value_type;
+            const uint64_t nameSize = std::strlen(name);
+            const uint64_t bytes = column.size() * sizeof(T);
+            out.write(reinterpret_cast<const char*>(&nameSize), sizeof(nameSize));
+            out.write(name, static_cast<std::streamsize>(nameSize));
+            out.write(reinterpret_cast<const char*>(&bytes), sizeof(bytes));
+            out.write(reinterpret_cast<const char*>(column.data()), static_cast<std::streamsize>(bytes));
+        });
+        if (!out) {
+            out.close();
+            std::error_code ec;
+            std::filesystem::remove(tmp, ec);
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, entryPath(c, key), ec);
+    if (ec) std::filesystem::remove(tmp, ec);
+    evict(c);
+}
+
+}  // namespace trace_cache
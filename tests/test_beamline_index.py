@@ -0,0 +1,108 @@
+# tests/test_beamline_index.py
+"""Tests for Beamline component lookup: by name, position and slice, keys() / items(), and wrapper identity."""
+import gc
+import sys
+import weakref
+from pathlib import Path
+
+import pytest
+
+sys.path.insert(0, str(Path(__file__).parent.parent))
+
+import rayx
+
+RML_FILE = Path(__file__).parent / "res" / "test.rml"
+
+
+@pytest.fixture
+def beamline():
+    return rayx.import_beamline(str(RML_FILE))
+
+
+def test_keys_order(beamline):
+    names = [c.name for c in beamline.elements] + [s.name for s in beamline.sources]
+    assert beamline.keys() == names
+    assert len(beamline) == len(names)
+
+
+def test_items(beamline):
+    for name, component in beamline.items():
+        assert component.name == name
+        assert component is beamline[name]
+
+
+def test_getitem_by_name_returns_same_object(beamline):
+    m1 = beamline["M1-Cylinder"]
+    assert beamline["M1-Cylinder"] is m1
+    assert beamline.elements[1] is m1
+
+
+def test_getitem_by_index(beamline):
+    components = list(beamline.elements) + list(beamline.sources)
+    for i, component in enumerate(components):
+        assert beamline[i] is component
+    assert beamline[-1] is beamline.sources[-1]
+    with pytest.raises(IndexError):
+        beamline[len(components)]
+    with pytest.raises(IndexError):
+        beamline[-len(components) - 1]
+
+
+def test_getitem_by_slice(beamline):
+    names = beamline.keys()
+    assert [c.name for c in beamline[1:4]] == names[1:4]
+    assert [c.name for c in beamline[::-2]] == names[::-2]
+    assert beamline[5:2] == []
+
+
+def test_iteration(beamline):
+    assert [c.name for c in beamline] == beamline.keys()
+
+
+def test_contains(beamline):
+    assert "ImagePlane" in beamline
+    assert "Point Source" in beamline
+    assert "nope" not in beamline
+
+
+def test_missing_name(beamline):
+    with pytest.raises(KeyError):
+        beamline["nope"]
+    assert issubclass(rayx.ComponentNotFoundError, RuntimeError)
+
+
+def test_rename_keeps_index_consistent(beamline):
+    m1 = beamline["M1-Cylinder"]
+    m1.name = "M1"
+    assert beamline["M1"] is m1
+    assert "M1-Cylinder" not in beamline
+    assert beamline.keys()[1] == "M1"
+
+
+def test_rename_to_existing_name_first_wins(beamline):
+    names = beamline.keys()
+    first, later = beamline[0], beamline[3]
+    assert beamline[names[3]] is later
+    first.name = names[3]
+    assert beamline[names[3]] is first
+    first.name = names[0]
+    assert beamline[names[3]] is later
+
+
+def test_set_through_lookup_persists(beamline):
+    for value in (0.5, 1.0, 1.5):
+        beamline["M1-Cylinder"].position.z = value
+        assert beamline["M1-Cylinder"].position.z == pytest.approx(value)
+
+
+def test_component_keeps_beamline_alive():
+    bl = rayx.import_beamline(str(RML_FILE))
+    ref = weakref.ref(bl)
+    m1 = bl["M1-Cylinder"]
+    del bl
+    gc.collect()
+    assert ref() is not None
+    assert m1.name == "M1-Cylinder"
+    del m1
+    gc.collect()
+    assert ref() is None
@@ -0,0 +1,69 @@
+# tests/test_caustic.py
+import sys
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+sys.path.insert(0, str(Path(__file__).parent.parent))
+
+import rayx
+
+RML_FILE = Path(__file__).parent / "res" / "test.rml"
+DISTANCES = np.linspace(-500.0, 500.0, 41)
+
+
+@pytest.fixture(scope="module")
+def beamline():
+    return rayx.import_beamline(str(RML_FILE))
+
+
+@pytest.fixture(scope="module")
+def rays(beamline):
+    return beamline.trace(seed=rayx.FIXED_SEED)
+
+
+@pytest.fixture(scope="module")
+def image_plane(beamline):
+    return [e.name for e in beamline.elements].index("ImagePlane")
+
+
+def _brute_force_z(rays, obj, distances):
+    # Reference: propagate every ray to each plane z = z0 + d in numpy.
+    sel = (np.asarray(rays.object_id) == obj) & (np.asarray(rays.event_type) == int(rayx.EventType.HIT_ELEMENT))
+    p = np.stack([np.asarray(getattr(rays, f"position_{a}"))[sel] for a in "xyz"], axis=1)
+    d = np.stack([np.asarray(getattr(rays, f"direction_{a}"))[sel] for a in "xyz"], axis=1)
+    z0 = p[:, 2].mean()
+    widths, heights = [], []
+    for dist in distances:
+        t = (z0 + dist - p[:, 2]) / d[:, 2]
+        q = p + t[:, None] * d
+        widths.append(q[:, 0].std())
+        heights.append(q[:, 1].std())
+    return np.array(widths), np.array(heights)
+
+
+def test_caustic_shapes(rays, image_plane):
+    c = rays.caustic(image_plane, DISTANCES)
+    for key in ["distance", "centroid_u", "centroid_v", "rms_width", "rms_height"]:
+        assert c[key].shape == DISTANCES.shape, key
+    assert c["rays"] > 0
+    assert c["best_focus"] in DISTANCES
+
+
+def test_caustic_matches_brute_force(rays, image_plane):
+    c = rays.caustic(image_plane, DISTANCES, axis="z")
+    widths, heights = _brute_force_z(rays, image_plane, DISTANCES)
+    assert np.allclose(c["rms_width"], widths, rtol=1e-6, atol=1e-9)
+    assert np.allclose(c["rms_height"], heights, rtol=1e-6, atol=1e-9)
+
+
+def test_caustic_best_focus_is_minimum(rays, image_plane):
+    c = rays.caustic(image_plane, DISTANCES)
+    size = c["rms_width"] ** 2 + c["rms_height"] ** 2
+    assert c["best_focus"] == DISTANCES[np.argmin(size)]
+
+
+def test_caustic_rejects_bad_axis(rays, image_plane):
+    with pytest.raises(ValueError):
+        rays.caustic(image_plane, DISTANCES, axis="w")
@@ -0,0 +1,56 @@
+# tests/test_energy_scan.py
+import sys
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+sys.path.insert(0, str(Path(__file__).parent.parent))
+
+import rayx
+
+RML_FILE = Path(__file__).parent / "res" / "test.rml"
+ENERGIES = [300.0, 318.0, 340.0]
+
+
+@pytest.fixture(scope="module")
+def beamline():
+    return rayx.import_beamline(str(RML_FILE))
+
+
+@pytest.fixture(scope="module")
+def scan(beamline):
+    return beamline.energy_scan(ENERGIES, design_energy=["Spherical Grating"], seed=rayx.FIXED_SEED)
+
+
+def test_energy_scan_shapes(beamline, scan):
+    n_elements = len(beamline.elements)
+    assert np.array_equal(scan["energy"], ENERGIES)
+    assert len(scan["elements"]) == n_elements
+    for key in ["transmission", "count", "mean_energy", "bandwidth", "mean_x", "rms_x", "mean_y", "rms_y"]:
+        assert scan[key].shape == (len(ENERGIES), n_elements), key
+
+
+def test_energy_scan_transmission_in_unit_range(scan):
+    assert np.all(scan["transmission"] >= 0.0)
+    assert np.all(scan["transmission"] <= 1.0)
+
+
+def test_energy_scan_tracks_source_energy(scan):
+    # The first element (the aperture) sees the source energy directly.
+    hit = scan["count"][:, 0] > 0
+    assert np.allclose(scan["mean_energy"][hit, 0], np.asarray(ENERGIES)[hit])
+
+
+def test_energy_scan_restores_energies():
+    bl = rayx.import_beamline(str(RML_FILE))
+    source_energy = bl.sources[0].energy
+    design_energy = bl["Spherical Grating"].designEnergy
+    bl.energy_scan(ENERGIES, design_energy=["Spherical Grating"], seed=rayx.FIXED_SEED)
+    assert bl.sources[0].energy == source_energy
+    assert bl["Spherical Grating"].designEnergy == design_energy
+
+
+def test_energy_scan_rejects_unknown_element(beamline):
+    with pytest.raises(ValueError):
+        beamline.energy_scan(ENERGIES, design_energy=["NoSuchElement"])
@@ -0,0 +1,58 @@
+# tests/test_pickle.py
+import pickle
+import sys
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+sys.path.insert(0, str(Path(__file__).parent.parent))
+
+import rayx
+
+RML_FILE = Path(__file__).parent / "res" / "test.rml"
+COLUMNS = ["path_id", "position_x", "direction_z", "electric_field_x", "energy", "object_id", "event_type"]
+
+
+@pytest.fixture(scope="module")
+def rays():
+    bl = rayx.import_beamline(str(RML_FILE))
+    return bl.trace(seed=rayx.FIXED_SEED)
+
+
+def _assert_equal(a, b):
+    assert len(a) == len(b)
+    for col in COLUMNS:
+        assert np.array_equal(np.asarray(getattr(a, col)), np.asarray(getattr(b, col))), col
+
+
+@pytest.mark.parametrize("protocol", [2, 4, 5])
+def test_pickle_roundtrip(rays, protocol):
+    _assert_equal(rays, pickle.loads(pickle.dumps(rays, protocol=protocol)))
+
+
+def test_pickle_protocol5_out_of_band(rays):
+    buffers = []
+    data = pickle.dumps(rays, protocol=5, buffer_callback=buffers.append)
+    assert len(buffers) > 0
+    # The column payload travels out of band, so the pickle stream itself stays small.
+    assert len(data) < sum(b.raw().nbytes for b in buffers)
+    _assert_equal(rays, pickle.loads(data, buffers=buffers))
+
+
+def test_from_buffers_rejects_missing_column(rays):
+    with pytest.raises(ValueError):
+        rayx.Rays.from_buffers({"path_id": np.asarray(rays.path_id)})
+
+
+def test_from_buffers_rejects_mismatched_dtype(rays):
+    _, (columns, *_) = rays.__reduce_ex__(4)
+    columns["position_x"] = np.asarray(rays.position_x).astype(np.float32)
+    with pytest.raises(ValueError, match="position_x"):
+        rayx.Rays.from_buffers(columns)
+
+
+def test_from_buffers_accepts_typed_arrays(rays):
+    _, (columns, *_) = rays.__reduce_ex__(4)
+    columns["position_x"] = np.asarray(rays.position_x)
+    _assert_equal(rays, rayx.Rays.from_buffers(columns))
@@ -0,0 +1,49 @@
+# tests/test_sensitivity.py
+import sys
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+sys.path.insert(0, str(Path(__file__).parent.parent))
+
+import rayx
+
+RML_FILE = Path(__file__).parent / "res" / "test.rml"
+
+PARAMS = ["E1.position.x", "E2.position.y"]
+OUTPUTS = ["mean_x@ImagePlane", "mean_y@ImagePlane", "transmission@ImagePlane"]
+
+
+@pytest.fixture(scope="module")
+def beamline():
+    return rayx.import_beamline(str(RML_FILE))
+
+
+def test_sensitivity_shape(beamline):
+    jac = beamline.sensitivity(PARAMS, 0.01, OUTPUTS, seed=rayx.FIXED_SEED)
+    assert jac.shape == (len(OUTPUTS), len(PARAMS))
+    assert jac.dtype == np.float64
+    assert np.all(np.isfinite(jac))
+
+
+def test_sensitivity_is_deterministic_with_seed(beamline):
+    a = beamline.sensitivity(PARAMS, [0.01, 0.02], OUTPUTS, seed=rayx.FIXED_SEED)
+    b = beamline.sensitivity(PARAMS, [0.01, 0.02], OUTPUTS, seed=rayx.FIXED_SEED)
+    assert np.array_equal(a, b)
+
+
+def test_sensitivity_restores_parameters(beamline):
+    before = beamline["E1"].position.x
+    beamline.sensitivity(PARAMS, 0.01, OUTPUTS, seed=rayx.FIXED_SEED)
+    assert beamline["E1"].position.x == before
+
+
+def test_sensitivity_rejects_unknown_output(beamline):
+    with pytest.raises(ValueError):
+        beamline.sensitivity(PARAMS, 0.01, ["rms_x@NoSuchElement"])
+
+
+def test_sensitivity_rejects_step_length_mismatch(beamline):
+    with pytest.raises(ValueError):
+        beamline.sensitivity(PARAMS, [0.01], OUTPUTS)
@@ -0,0 +1,133 @@
+# tests/test_trace_budget.py
+"""Tests for batched, time-budgeted and interruptible Beamline.trace()."""
+import _thread
+import pickle
+import sys
+import threading
+import time
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+sys.path.insert(0, str(Path(__file__).parent.parent))
+
+import rayx
+
+RML_FILE = Path(__file__).parent / "res" / "test.rml"
+
+
+@pytest.fixture
+def beamline():
+    return rayx.import_beamline(str(RML_FILE))
+
+
+def nominal_rays(beamline):
+    return sum(source.numberOfRays for source in beamline.sources)
+
+
+def test_unbatched_trace_reports_source_rays(beamline):
+    rays = beamline.trace(seed=rayx.FIXED_SEED)
+    assert rays.source_rays == nominal_rays(beamline)
+    assert rays.complete
+
+
+def test_batched_trace_completes(beamline):
+    total = nominal_rays(beamline)
+    rays = beamline.trace(seed=rayx.FIXED_SEED, batch_size=total // 4)
+    assert rays.complete
+    assert rays.source_rays == total
+    assert len(rays) > 0
+    path_id = np.asarray(rays.path_id)
+    assert path_id.min() >= 0
+    assert path_id.max() < total
+
+
+def test_uneven_batches_emit_exact_total(beamline):
+    total = nominal_rays(beamline)
+    rays = beamline.trace(seed=rayx.FIXED_SEED, batch_size=total // 3 + 1)
+    assert rays.complete
+    assert rays.source_rays == total
+
+
+def test_batched_trace_is_reproducible(beamline):
+    total = nominal_rays(beamline)
+    a = beamline.trace(seed=rayx.FIXED_SEED, batch_size=total // 3)
+    b = beamline.trace(seed=rayx.FIXED_SEED, batch_size=total // 3)
+    np.testing.assert_array_equal(np.asarray(a.position_x), np.asarray(b.position_x))
+    np.testing.assert_array_equal(np.asarray(a.path_id), np.asarray(b.path_id))
+
+
+def test_batched_trace_restores_ray_counts(beamline):
+    before = [source.numberOfRays for source in beamline.sources]
+    beamline.trace(seed=rayx.FIXED_SEED, batch_size=100)
+    assert [source.numberOfRays for source in beamline.sources] == before
+
+
+def test_zero_time_budget_returns_empty(beamline):
+    rays = beamline.trace(seed=rayx.FIXED_SEED, time_budget=0.0)
+    assert not rays.complete
+    assert rays.source_rays == 0
+    assert len(rays) == 0
+
+
+def test_past_deadline_returns_empty(beamline):
+    rays = beamline.trace(seed=rayx.FIXED_SEED, deadline=time.time() - 1.0)
+    assert not rays.complete
+    assert rays.source_rays == 0
+
+
+def test_generous_budget_completes(beamline):
+    rays = beamline.trace(seed=rayx.FIXED_SEED, time_budget=3600.0)
+    assert rays.complete
+    assert rays.source_rays == nominal_rays(beamline)
+
+
+def test_negative_time_budget_rejected(beamline):
+    with pytest.raises(ValueError):
+        beamline.trace(time_budget=-1.0)
+
+
+def test_nan_deadline_rejected(beamline):
+    with pytest.raises(ValueError):
+        beamline.trace(deadline=float("nan"))
+
+
+def test_attributes_survive_pickle(beamline):
+    rays = beamline.trace(seed=rayx.FIXED_SEED, time_budget=0.0)
+    restored = pickle.loads(pickle.dumps(rays))
+    assert restored.source_rays == 0
+    assert not restored.complete
+
+
+def test_untraced_rays_have_defaults():
+    rays = rayx.Rays()
+    assert rays.source_rays == 0
+    assert rays.complete
+
+
+def test_keyboard_interrupt_returns_partial(beamline):
+    beamline.sources[0].numberOfRays = 1_000_000
+    timer = threading.Timer(0.2, _thread.interrupt_main)
+    timer.start()
+    try:
+        rays = beamline.trace(seed=rayx.FIXED_SEED, batch_size=1000)
+    finally:
+        timer.cancel()
+    assert not rays.complete
+    assert 0 < rays.source_rays < 1_000_000
+    assert np.asarray(rays.path_id).max() < rays.source_rays
+
+
+def test_keyboard_interrupt_in_last_batch_is_raised(beamline):
+    beamline.sources[0].numberOfRays = 1_000_000
+    timer = threading.Timer(0.2, _thread.interrupt_main)
+    timer.start()
+    try:
+        with pytest.raises(KeyboardInterrupt):
+            # A single batch: nothing is skipped, so the interrupt must not be swallowed. Should the trace finish before the
+            # timer fires, the interrupt arrives during the sleep instead.
+            beamline.trace(seed=rayx.FIXED_SEED, batch_size=1_000_000)
+            time.sleep(5.0)
+    finally:
+        timer.cancel()
@@ -0,0 +1,88 @@
+# tests/test_trace_cache.py
+import sys
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+sys.path.insert(0, str(Path(__file__).parent.parent))
+
+import rayx
+
+RML_FILE = Path(__file__).parent / "res" / "test.rml"
+
+
+@pytest.fixture
+def cache_dir(tmp_path):
+    rayx.set_trace_cache(str(tmp_path))
+    yield tmp_path
+    rayx.set_trace_cache(None)
+
+
+def _entries(path):
+    return sorted(path.glob("*.rays"))
+
+
+def test_seeded_trace_is_cached(cache_dir):
+    bl = rayx.import_beamline(str(RML_FILE))
+    first = bl.trace(seed=rayx.FIXED_SEED)
+    assert len(_entries(cache_dir)) == 1
+    second = bl.trace(seed=rayx.FIXED_SEED)
+    assert len(_entries(cache_dir)) == 1
+    for col in ["path_id", "position_x", "electric_field_y", "event_type"]:
+        assert np.array_equal(np.asarray(getattr(first, col)), np.asarray(getattr(second, col))), col
+
+
+def test_unseeded_trace_is_not_cached(cache_dir):
+    bl = rayx.import_beamline(str(RML_FILE))
+    bl.trace()
+    assert _entries(cache_dir) == []
+
+
+def test_key_covers_state_and_arguments(cache_dir):
+    bl = rayx.import_beamline(str(RML_FILE))
+    bl.trace(seed=rayx.FIXED_SEED)
+    bl.trace(seed=rayx.FIXED_SEED + 1)
+    bl.trace(seed=rayx.FIXED_SEED, sequential=True)
+    bl["E1"].position.x = bl["E1"].position.x + 0.5
+    bl.trace(seed=rayx.FIXED_SEED)
+    assert len(_entries(cache_dir)) == 4
+
+
+def test_key_covers_device_selection(cache_dir):
+    bl = rayx.import_beamline(str(RML_FILE))
+    bl.trace(seed=rayx.FIXED_SEED, device_type=rayx.DeviceType.Cpu)
+    bl.trace(seed=rayx.FIXED_SEED, device_type=rayx.DeviceType.All)
+    assert len(_entries(cache_dir)) == 2
+
+
+def test_key_covers_profile_file(cache_dir, tmp_path_factory):
+    bl = rayx.import_beamline(str(RML_FILE))
+    profile = tmp_path_factory.mktemp("profiles") / "profile.dat"
+    profile.write_text("0.0 0.0\n")
+    bl["M1-Cylinder"].profileFile = str(profile)
+    bl.trace(seed=rayx.FIXED_SEED)
+    bl.trace(seed=rayx.FIXED_SEED)
+    assert len(_entries(cache_dir)) == 1
+    profile.write_text("0.0 1.0\n")
+    bl.trace(seed=rayx.FIXED_SEED)
+    assert len(_entries(cache_dir)) == 2
+
+
+def test_lru_eviction(tmp_path):
+    bl = rayx.import_beamline(str(RML_FILE))
+    rayx.set_trace_cache(str(tmp_path))
+    try:
+        bl.trace(seed=1)
+        size = _entries(tmp_path)[0].stat().st_size
+        # Room for two entries: the third store evicts the least recently used one.
+        rayx.set_trace_cache(str(tmp_path), max_bytes=2 * size + size // 2)
+        bl.trace(seed=2)
+        bl.trace(seed=1)  # hit, refreshes seed 1
+        bl.trace(seed=3)
+        assert len(_entries(tmp_path)) == 2
+        before = {p.name for p in _entries(tmp_path)}
+        bl.trace(seed=1)
+        assert {p.name for p in _entries(tmp_path)} == before
+    finally:
+        rayx.set_trace_cache(None)
@@ -0,0 +1,64 @@
+# tests/test_trace_out.py
+import sys
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+sys.path.insert(0, str(Path(__file__).parent.parent))
+
+import rayx
+
+RML_FILE = Path(__file__).parent / "res" / "test.rml"
+
+
+@pytest.fixture(scope="module")
+def beamline():
+    return rayx.import_beamline(str(RML_FILE))
+
+
+def test_trace_out_returns_buffer(beamline):
+    buf = rayx.Rays()
+    assert len(buf) == 0
+    rays = beamline.trace(seed=rayx.FIXED_SEED, out=buf)
+    assert rays is buf
+    assert len(buf) > 0
+    assert buf.source_rays == sum(source.numberOfRays for source in beamline.sources)
+
+
+def test_trace_out_matches_fresh_trace(beamline):
+    fresh = beamline.trace(seed=rayx.FIXED_SEED)
+    buf = beamline.trace(seed=rayx.FIXED_SEED, out=rayx.Rays())
+    assert np.array_equal(np.asarray(fresh.position_x), np.asarray(buf.position_x))
+    assert np.array_equal(np.asarray(fresh.path_id), np.asarray(buf.path_id))
+
+
+def test_trace_out_reuses_storage(beamline):
+    buf = rayx.Rays()
+    beamline.trace(seed=rayx.FIXED_SEED, out=buf)
+    view = np.asarray(buf.position_x)
+    before = view.copy()
+    view[:] = 0.0
+
+    # Same seed, same number of events: the column is overwritten in place, so the old view sees the new data.
+    beamline.trace(seed=rayx.FIXED_SEED, out=buf)
+    assert np.array_equal(view, before)
+
+
+def test_growing_under_live_view_raises_buffer_error(beamline):
+    buf = rayx.Rays()
+    view = buf.position_x
+    with pytest.raises(BufferError):
+        beamline.trace(seed=rayx.FIXED_SEED, out=buf)
+    with pytest.raises(BufferError):
+        buf.reserve(1000)
+    del view
+    beamline.trace(seed=rayx.FIXED_SEED, out=buf)
+    assert len(buf) > 0
+
+
+def test_reserve_sets_capacity():
+    buf = rayx.Rays()
+    buf.reserve(1000)
+    assert buf.capacity >= 1000
+    assert len(buf) == 0
@@ -0,0 +1,46 @@
+# tests/test_trace_until.py
+import sys
+from pathlib import Path
+
+import pytest
+
+sys.path.insert(0, str(Path(__file__).parent.parent))
+
+import rayx
+
+RML_FILE = Path(__file__).parent / "res" / "test.rml"
+
+
+@pytest.fixture
+def beamline():
+    return rayx.import_beamline(str(RML_FILE))
+
+
+def test_trace_until_converges(beamline):
+    target = {"transmission@ImagePlane": 0.05, "rms_x@ImagePlane": 1.0}
+    result = beamline.trace_until(target, max_rays=200_000, batch_size=1000, seed=rayx.FIXED_SEED)
+    assert result["converged"]
+    assert set(result["values"]) == set(target)
+    for key, tol in target.items():
+        assert result["errors"][key] <= tol
+    assert 0 < result["rays"] <= 200_000
+
+
+def test_trace_until_stops_at_max_rays(beamline):
+    result = beamline.trace_until({"rms_x@ImagePlane": 1e-12}, max_rays=3000, batch_size=1000, seed=rayx.FIXED_SEED)
+    assert not result["converged"]
+    assert result["rays"] == 3000
+    assert result["batches"] == 2
+
+
+def test_trace_until_is_reproducible(beamline):
+    target = {"mean_y@ImagePlane": 0.1}
+    a = beamline.trace_until(target, max_rays=20_000, batch_size=1000, seed=rayx.FIXED_SEED)
+    b = beamline.trace_until(target, max_rays=20_000, batch_size=1000, seed=rayx.FIXED_SEED)
+    assert a == b
+
+
+def test_trace_until_restores_ray_counts(beamline):
+    before = beamline.sources[0].numberOfRays
+    beamline.trace_until({"count@ImagePlane": 1.0}, max_rays=1000, batch_size=500)
+    assert beamline.sources[0].numberOfRays == before
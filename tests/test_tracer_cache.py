@@ -0,0 +1,47 @@
+# tests/test_tracer_cache.py
+import sys
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+sys.path.insert(0, str(Path(__file__).parent.parent))
+
+import rayx
+
+RML_FILE = Path(__file__).parent / "res" / "test.rml"
+
+
+@pytest.fixture
+def tracer_cache():
+    rayx.set_tracer_cache(True)
+    yield
+    rayx.set_tracer_cache(False)
+
+
+def test_kept_tracer_gives_same_rays(tracer_cache):
+    bl = rayx.import_beamline(str(RML_FILE))
+    first = np.asarray(bl.trace(seed=rayx.FIXED_SEED).position_x).copy()
+    second = np.asarray(bl.trace(seed=rayx.FIXED_SEED).position_x)
+    assert np.array_equal(first, second)
+
+
+def test_trace_after_clear_is_unchanged(tracer_cache):
+    bl = rayx.import_beamline(str(RML_FILE))
+    before = np.asarray(bl.trace(seed=rayx.FIXED_SEED).position_x).copy()
+    rayx.clear_tracer_cache()
+    after = np.asarray(bl.trace(seed=rayx.FIXED_SEED).position_x)
+    assert np.array_equal(before, after)
+
+
+def test_uncached_trace_matches_cached(tracer_cache):
+    bl = rayx.import_beamline(str(RML_FILE))
+    cached = np.asarray(bl.trace(seed=rayx.FIXED_SEED).position_x).copy()
+    rayx.set_tracer_cache(False)
+    uncached = np.asarray(bl.trace(seed=rayx.FIXED_SEED).position_x)
+    assert np.array_equal(cached, uncached)
+
+
+def test_clear_is_idempotent():
+    rayx.clear_tracer_cache()
+    rayx.clear_tracer_cache()
@@ -0,0 +1,72 @@
+# tests/test_transforms.py
+"""Tests for the bulk pose API (get_transforms / set_transforms) and misalignment_study."""
+import sys
+from pathlib import Path
+
+import numpy as np
+import pytest
+
+sys.path.insert(0, str(Path(__file__).parent.parent))
+
+import rayx
+
+RML_FILE = Path(__file__).parent / "res" / "test.rml"
+
+
+@pytest.fixture
+def beamline():
+    return rayx.import_beamline(str(RML_FILE))
+
+
+def test_get_transforms_shapes(beamline):
+    positions, orientations = beamline.get_transforms()
+    n = len(beamline.elements) + len(beamline.sources)
+    assert positions.shape == (n, 4)
+    assert orientations.shape == (n, 4, 4)
+
+
+def test_get_transforms_matches_properties(beamline):
+    _, orientations = beamline.get_transforms()
+    for i, element in enumerate(beamline.elements):
+        assert np.allclose(orientations[i, :3, :3], np.asarray(element.orientation)[:3, :3])
+
+
+def test_set_transforms_roundtrip_leaves_trace_unchanged(beamline):
+    baseline = np.asarray(beamline.trace(seed=rayx.FIXED_SEED).position_x).copy()
+    beamline.set_transforms(*beamline.get_transforms())
+    after = np.asarray(beamline.trace(seed=rayx.FIXED_SEED).position_x)
+    assert np.array_equal(baseline, after)
+
+
+def test_set_transforms_moves_component(beamline):
+    positions, orientations = beamline.get_transforms()
+    positions[0, 0] += 1.0
+    beamline.set_transforms(positions, orientations)
+    assert np.allclose(beamline.get_transforms()[0][0], positions[0])
+
+
+def test_set_transforms_rejects_wrong_count(beamline):
+    positions, orientations = beamline.get_transforms()
+    with pytest.raises(ValueError):
+        beamline.set_transforms(positions[:-1], orientations[:-1])
+
+
+def test_orientation_accepts_non_contiguous_array():
+    # The contiguous fast path must not break the element-wise fallback.
+    bl = rayx.import_beamline(str(RML_FILE))
+    m = np.eye(8)[::2, ::2]
+    assert not m.flags.c_contiguous
+    bl.sources[0].orientation = m
+    assert np.allclose(np.asarray(bl.sources[0].orientation), np.eye(4))
+
+
+def test_misalignment_study(beamline):
+    positions, _ = beamline.get_transforms()
+    result = beamline.misalignment_study(
+        3, {"E1": [0.1, 0.1, 0.0, 1e-4, 0.0, 0.0]}, ["mean_x@ImagePlane", "rms_y@ImagePlane"], seed=rayx.FIXED_SEED
+    )
+    assert result["components"] == ["E1"]
+    assert result["offsets"].shape == (3, 1, 6)
+    assert result["outputs"].shape == (3, 2)
+    assert np.all(result["offsets"][:, 0, 2] == 0.0)
+    assert np.array_equal(beamline.get_transforms()[0], positions)
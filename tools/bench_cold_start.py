@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+"""Measure the time from a fresh interpreter to the first finished trace.
+
+Each run starts a new Python process that imports rayx, imports an RML file and
+traces it twice. With --keep-tracers the second trace reuses the Tracer kept by
+rayx.set_tracer_cache(True); the first trace is not affected by it. Usage:
+
+    uv run python tools/bench_cold_start.py [RML] [--runs N] [--keep-tracers]
+"""
+import argparse
+import json
+import statistics
+import subprocess
+import sys
+from pathlib import Path
+
+ROOT_DIR = Path(__file__).resolve().parent.parent
+DEFAULT_RML = ROOT_DIR / "tests" / "res" / "test.rml"
+
+CHILD = """
+import json, sys, time
+t0 = time.perf_counter()
+import rayx
+rayx.set_tracer_cache({keep_tracers!r})
+t1 = time.perf_counter()
+bl = rayx.import_beamline({rml!r})
+bl.trace(seed=rayx.FIXED_SEED)
+t2 = time.perf_counter()
+bl.trace(seed=rayx.FIXED_SEED)
+t3 = time.perf_counter()
+print(json.dumps({{"import": t1 - t0, "first_trace": t2 - t1, "second_trace": t3 - t2, "total": t2 - t0}}))
+"""
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("rml", nargs="?", default=str(DEFAULT_RML))
+    parser.add_argument("--runs", type=int, default=5)
+    parser.add_argument("--keep-tracers", action="store_true", help="enable rayx.set_tracer_cache(True)")
+    args = parser.parse_args()
+
+    code = CHILD.format(rml=args.rml, keep_tracers=args.keep_tracers)
+    runs = []
+    for _ in range(args.runs):
+        out = subprocess.run([sys.executable, "-c", code], check=True, capture_output=True, text=True, cwd=ROOT_DIR)
+        runs.append(json.loads(out.stdout.strip().splitlines()[-1]))
+
+    for key in ["import", "first_trace", "second_trace", "total"]:
+        values = [r[key] for r in runs]
+        print(f"{key:>12}: median {statistics.median(values) * 1e3:8.1f} ms  min {min(values) * 1e3:8.1f} ms")
+
+
+if __name__ == "__main__":
+    main()